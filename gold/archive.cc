@@ -26,6 +26,10 @@
 #include <cstring>
 #include <climits>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "libiberty.h"
 #include "filenames.h"
 
@@ -154,6 +158,63 @@ struct Archive::Archive_header
 unsigned int Archive::total_archives;
 unsigned int Archive::total_members;
 unsigned int Archive::total_members_loaded;
+unsigned int Archive::total_index_cache_hits;
+
+// The archive index cache.  With --archive-index-cache, the parsed
+// symbol map and the extended name table of each archive are saved in
+// a file in the cache directory, so that later links do not read or
+// parse them.  The symbol map already lists the symbols defined by
+// each member, so that is all that is needed to select members.  The
+// cache file is named for the device and inode of the archive, and is
+// only used if the archive has the same size and modification time as
+// when the file was written.  The file is written in the host format:
+// the header, the symbol map entries, the symbol names, and the
+// extended names.
+
+struct Archive::Index_cache_header
+{
+  // Index_cache_magic.
+  char magic[8];
+  // sizeof(Armap_entry), which depends on the host.
+  uint64_t entry_size;
+  // The identity of the archive.
+  uint64_t dev;
+  uint64_t ino;
+  uint64_t size;
+  int64_t mtime_seconds;
+  int64_t mtime_nanoseconds;
+  // The contents of the file.
+  uint64_t armap_size;
+  uint64_t num_members;
+  uint64_t armap_names_size;
+  uint64_t extended_names_size;
+};
+
+static const char index_cache_magic[8] =
+{
+  'g', 'o', 'l', 'd', 'a', 'i', 'c', '1'
+};
+
+// Write SIZE bytes at P to the descriptor O.  Return false on error.
+
+static bool
+write_all(int o, const void* p, size_t size)
+{
+  const char* pc = static_cast<const char*>(p);
+  while (size > 0)
+    {
+      ssize_t len = ::write(o, pc, size);
+      if (len < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return false;
+	}
+      pc += len;
+      size -= len;
+    }
+  return true;
+}
 
 // Archive methods.
 
@@ -172,16 +233,17 @@ const char Archive::arfmag[2] = { '`', '\n' };
 Archive::Archive(const std::string& name, Input_file* input_file,
                  bool is_thin_archive, Dirsearch* dirpath, Task* task)
   : Library_base(task), name_(name), input_file_(input_file), armap_(),
-    armap_names_(), extended_names_(), armap_checked_(), seen_offsets_(),
-    members_(), is_thin_archive_(is_thin_archive), included_member_(false),
-    nested_archives_(), dirpath_(dirpath), num_members_(0)
+    armap_names_(), extended_names_(), armap_checked_(), armap_unique_(),
+    seen_offsets_(), members_(), is_thin_archive_(is_thin_archive),
+    included_member_(false), nested_archives_(), dirpath_(dirpath),
+    num_members_(0)
 {
   this->no_export_ =
     parameters->options().check_excluded_libs(input_file->found_name());
 }
 
 // Set up the archive: read the symbol map and the extended name
-// table.
+// table, from the archive index cache if possible.
 
 void
 Archive::setup()
@@ -190,6 +252,36 @@ Archive::setup()
   if (this->input_file_->file().filesize() == sarmag)
     return;
 
+  const char* cache_dir = parameters->options().archive_index_cache();
+  Index_cache_header key;
+  std::string cache_name;
+  bool use_cache = (cache_dir != NULL
+		    && this->index_cache_key(cache_dir, &key, &cache_name));
+  if (use_cache && this->read_index_cache(cache_name, key))
+    ++Archive::total_index_cache_hits;
+  else if (this->read_symbol_map_and_names()
+	   && use_cache
+	   && parameters->errors()->error_count() == 0)
+    this->write_index_cache(cache_name, key);
+
+  bool preread_syms = (parameters->options().threads()
+                       && parameters->options().preread_archive_symbols());
+#ifndef ENABLE_THREADS
+  preread_syms = false;
+#else
+  if (parameters->options().has_plugins())
+    preread_syms = false;
+#endif
+  if (preread_syms)
+    this->read_all_symbols();
+}
+
+// Read the symbol map and the extended name table from the archive.
+// Return whether the archive has a symbol map.
+
+bool
+Archive::read_symbol_map_and_names()
+{
   // The first member of the archive should be the symbol table.
   std::string armap_name;
   section_size_type armap_size =
@@ -220,16 +312,8 @@ Archive::setup()
       const char* px = reinterpret_cast<const char*>(p);
       this->extended_names_.assign(px, extended_size);
     }
-  bool preread_syms = (parameters->options().threads()
-                       && parameters->options().preread_archive_symbols());
-#ifndef ENABLE_THREADS
-  preread_syms = false;
-#else
-  if (parameters->options().has_plugins())
-    preread_syms = false;
-#endif
-  if (preread_syms)
-    this->read_all_symbols();
+
+  return armap_name.empty();
 }
 
 // Unlock any nested archives.
@@ -295,6 +379,154 @@ Archive::read_armap(off_t start, section_size_type size)
   this->armap_checked_.resize(nsyms);
 }
 
+// Set *KEY to identify the archive in the archive index cache.  The
+// archive is locked, so its descriptor is open.
+
+bool
+Archive::index_cache_key(const char* dir, Index_cache_header* key,
+			 std::string* cache_name)
+{
+  struct stat st;
+  if (::fstat(this->file().descriptor(), &st) < 0)
+    return false;
+  Timespec mtime = this->file().get_mtime();
+
+  memset(key, 0, sizeof *key);
+  memcpy(key->magic, index_cache_magic, sizeof key->magic);
+  key->entry_size = sizeof(Armap_entry);
+  key->dev = st.st_dev;
+  key->ino = st.st_ino;
+  key->size = st.st_size;
+  key->mtime_seconds = mtime.seconds;
+  key->mtime_nanoseconds = mtime.nanoseconds;
+
+  char buf[100];
+  snprintf(buf, sizeof buf, "/%llx-%llx.armap",
+	   static_cast<unsigned long long>(key->dev),
+	   static_cast<unsigned long long>(key->ino));
+  *cache_name = dir;
+  *cache_name += buf;
+  return true;
+}
+
+// Read the symbol map and the extended name table from the archive
+// index cache.
+
+bool
+Archive::read_index_cache(const std::string& cache_name,
+			  const Index_cache_header& key)
+{
+  int o = ::open(cache_name.c_str(), O_RDONLY);
+  if (o < 0)
+    return false;
+
+  struct stat st;
+  if (::fstat(o, &st) < 0
+      || static_cast<size_t>(st.st_size) < sizeof(Index_cache_header))
+    {
+      ::close(o);
+      return false;
+    }
+
+  size_t file_size = st.st_size;
+  void* map = ::mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, o, 0);
+  ::close(o);
+  if (map == MAP_FAILED)
+    return false;
+
+  const unsigned char* p = static_cast<const unsigned char*>(map);
+  const Index_cache_header* hdr =
+    reinterpret_cast<const Index_cache_header*>(p);
+  bool ok = (memcmp(hdr, &key, offsetof(Index_cache_header, armap_size)) == 0
+	     && hdr->armap_size <= file_size / sizeof(Armap_entry)
+	     && hdr->armap_names_size <= file_size
+	     && hdr->extended_names_size <= file_size
+	     && (sizeof(Index_cache_header)
+		 + hdr->armap_size * sizeof(Armap_entry)
+		 + hdr->armap_names_size
+		 + hdr->extended_names_size) == file_size);
+
+  const Armap_entry* entries = NULL;
+  const char* names = NULL;
+  if (ok)
+    {
+      p += sizeof(Index_cache_header);
+      entries = reinterpret_cast<const Armap_entry*>(p);
+      p += hdr->armap_size * sizeof(Armap_entry);
+      names = reinterpret_cast<const char*>(p);
+      p += hdr->armap_names_size;
+
+      // Check each entry, so that a damaged cache file makes us read
+      // the symbol map from the archive instead.  Since the names end
+      // with a null byte, every name offset in range is a valid name.
+      if (hdr->armap_size > 0
+	  && (hdr->armap_names_size == 0
+	      || names[hdr->armap_names_size - 1] != '\0'))
+	ok = false;
+      for (uint64_t i = 0; ok && i < hdr->armap_size; ++i)
+	{
+	  if (entries[i].name_offset < 0
+	      || (static_cast<uint64_t>(entries[i].name_offset)
+		  >= hdr->armap_names_size)
+	      || entries[i].file_offset < sarmag
+	      || static_cast<uint64_t>(entries[i].file_offset) >= key.size)
+	    ok = false;
+	}
+    }
+
+  if (ok)
+    {
+      this->armap_.assign(entries, entries + hdr->armap_size);
+      this->armap_names_.assign(names, hdr->armap_names_size);
+      this->extended_names_.assign(reinterpret_cast<const char*>(p),
+				   hdr->extended_names_size);
+      this->num_members_ = hdr->num_members;
+      this->armap_checked_.resize(hdr->armap_size);
+    }
+
+  ::munmap(map, file_size);
+  return ok;
+}
+
+// Write the symbol map and the extended name table to the archive
+// index cache.  The file is written under a temporary name and then
+// renamed, so that a concurrent link never sees a partial file.  This
+// is only a cache, so errors are ignored.
+
+void
+Archive::write_index_cache(const std::string& cache_name,
+			   const Index_cache_header& key) const
+{
+  Index_cache_header hdr(key);
+  hdr.armap_size = this->armap_.size();
+  hdr.num_members = this->num_members_;
+  hdr.armap_names_size = this->armap_names_.size();
+  hdr.extended_names_size = this->extended_names_.size();
+
+  char buf[30];
+  snprintf(buf, sizeof buf, ".%ld", static_cast<long>(getpid()));
+  std::string tmp_name(cache_name);
+  tmp_name += buf;
+
+  int o = ::open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (o < 0)
+    return;
+
+  bool ok = (write_all(o, &hdr, sizeof hdr)
+	     && (this->armap_.empty()
+		 || write_all(o, &this->armap_[0],
+			      this->armap_.size() * sizeof(Armap_entry)))
+	     && write_all(o, this->armap_names_.data(),
+			  this->armap_names_.size())
+	     && write_all(o, this->extended_names_.data(),
+			  this->extended_names_.size()));
+  if (::close(o) < 0)
+    ok = false;
+
+  if (!ok || ::rename(tmp_name.c_str(), cache_name.c_str()) < 0)
+    ::unlink(tmp_name.c_str());
+}
+
 // Read the header of an archive member at OFF.  Fail if something
 // goes wrong.  Return the size of the member.  Set *PNAME to the name
 // of the member.
@@ -689,6 +921,152 @@ Archive::read_symbols(off_t off)
   this->members_[off] = member;
 }
 
+// Class Archive::Member_reader.  Part I of this reads the symbols of
+// the Ith member in a list.
+
+class Archive::Member_reader : public Parallel_runner
+{
+ public:
+  Member_reader(std::vector<Archive_member>* members)
+    : members_(members)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    Archive_member& member((*this->members_)[part]);
+    member.obj_->read_symbols(member.sd_);
+  }
+
+ private:
+  std::vector<Archive_member>* members_;
+};
+
+// Whether to read the symbols of the members needed by a pass of
+// add_symbols on several threads.  Plugins may claim members, the
+// members of a thin archive are in other files, and incremental links
+// report members as they are read, so those are left serial.
+
+bool
+Archive::should_read_needed_members() const
+{
+  return (Workqueue::parallel_thread_count() > 1
+	  && !this->is_thin_archive_
+	  && !parameters->options().has_plugins()
+	  && !parameters->incremental());
+}
+
+// Set armap_unique_[I] if no member other than the one of armap entry
+// I defines a symbol with the same name, ignoring any version.
+
+void
+Archive::find_unique_armap_names()
+{
+  typedef Unordered_map<std::string, off_t> Definers;
+  Definers definers;
+  const size_t armap_size = this->armap_.size();
+  std::vector<Definers::iterator> entries;
+  entries.reserve(armap_size);
+  for (size_t i = 0; i < armap_size; ++i)
+    {
+      const char* sym_name = (this->armap_names_.data()
+			      + this->armap_[i].name_offset);
+      std::string name(sym_name, strcspn(sym_name, "@"));
+      off_t off = this->armap_[i].file_offset;
+      std::pair<Definers::iterator, bool> ins =
+	definers.insert(std::make_pair(name, off));
+      if (!ins.second && ins.first->second != off)
+	ins.first->second = -1;
+      entries.push_back(ins.first);
+    }
+
+  this->armap_unique_.resize(armap_size);
+  for (size_t i = 0; i < armap_size; ++i)
+    this->armap_unique_[i] = entries[i]->second != -1;
+}
+
+// Read the symbols of the members which define a symbol that the link
+// needs now.  The objects are made in armap order, and their symbols
+// are read on several threads, into members_.  include_member then
+// uses them, in the same order as if they were read one at a time.
+//
+// Only members which this pass of add_symbols is certain to include
+// are read, so that any error reported while reading one is an error
+// the serial walk would report too.  The member of the first needed
+// symbol is always included, and it is included first.  Any other
+// member is only read if it defines a needed symbol which no other
+// member of the archive defines: during the pass only including a
+// member can define that symbol, so the walk will include this member
+// when it gets there.  include_member gives up on the archive if the
+// first member it includes is for some other target; the first member
+// is made first, and nothing else is read if it can't be made.
+
+void
+Archive::read_needed_members(Symbol_table* symtab, Layout* layout,
+			     char** tmpbufp, size_t* tmpbuflen)
+{
+  if (this->armap_unique_.size() != this->armap_.size())
+    this->find_unique_armap_names();
+
+  std::vector<off_t> offsets;
+  Unordered_set<off_t, Seen_hash> needed;
+  const size_t armap_size = this->armap_.size();
+  for (size_t i = 0; i < armap_size; ++i)
+    {
+      if (this->armap_checked_[i])
+	continue;
+      off_t off = this->armap_[i].file_offset;
+      if (this->seen_offsets_.find(off) != this->seen_offsets_.end()
+	  || needed.find(off) != needed.end()
+	  || (!needed.empty() && !this->armap_unique_[i]))
+	continue;
+
+      const char* sym_name = (this->armap_names_.data()
+			      + this->armap_[i].name_offset);
+      Symbol* sym;
+      std::string why;
+      if (Archive::should_include_member(symtab, layout, sym_name, &sym,
+					 &why, tmpbufp, tmpbuflen)
+	  == Archive::SHOULD_INCLUDE_YES)
+	{
+	  needed.insert(off);
+	  if (this->members_.find(off) == this->members_.end())
+	    offsets.push_back(off);
+	}
+    }
+
+  if (offsets.size() < 2)
+    return;
+
+  // Making the objects reads the file, so it is done here, in order.
+  // Stop at a member which is not an object for this target, and let
+  // include_member decide what to do with it.  A member with some
+  // other error is recorded with no object, so that the error is not
+  // reported again when it is included.
+  std::vector<Archive_member> members;
+  members.reserve(offsets.size());
+  for (size_t i = 0; i < offsets.size(); ++i)
+    {
+      bool unconfigured;
+      Object* obj = this->get_elf_object_for_member(offsets[i], &unconfigured);
+      if (obj == NULL)
+	{
+	  if (!unconfigured)
+	    this->members_[offsets[i]] = Archive_member();
+	  break;
+	}
+      members.push_back(Archive_member(obj, new Read_symbols_data));
+    }
+
+  this->file().start_concurrent_reads();
+  Member_reader reader(&members);
+  Workqueue::run_in_parallel(&reader, members.size());
+  this->file().end_concurrent_reads();
+
+  for (size_t i = 0; i < members.size(); ++i)
+    this->members_[offsets[i]] = members[i];
+}
+
 // Select members from the archive and add them to the link.  We walk
 // through the elements in the archive map, and look each one up in
 // the symbol table.  If it exists as a strong undefined symbol, we
@@ -724,9 +1102,13 @@ Archive::add_symbols(Symbol_table* symtab, Layout* layout,
 
   char* tmpbuf = NULL;
   size_t tmpbuflen = 0;
+  bool read_in_parallel = this->should_read_needed_members();
   bool added_new_object;
   do
     {
+      if (read_in_parallel)
+	this->read_needed_members(symtab, layout, &tmpbuf, &tmpbuflen);
+
       added_new_object = false;
       for (size_t i = 0; i < armap_size; ++i)
 	{
@@ -858,6 +1240,10 @@ Archive::include_member(Symbol_table* symtab, Layout* layout,
     {
       Object* obj = p->second.obj_;
 
+      // read_needed_members already reported an error for this member.
+      if (obj == NULL)
+	return true;
+
       Read_symbols_data* sd = p->second.sd_;
       if (mapfile != NULL)
         mapfile->report_include_archive_member(obj->name(), sym, why);
@@ -950,6 +1336,9 @@ Archive::print_stats()
           program_name, Archive::total_members);
   fprintf(stderr, _("%s: loaded archive members: %u\n"),
           program_name, Archive::total_members_loaded);
+  if (parameters->options().archive_index_cache() != NULL)
+    fprintf(stderr, _("%s: archives found in index cache: %u\n"),
+	    program_name, Archive::total_index_cache_hits);
 }
 
 // Add_archive_symbols methods.
@@ -273,22 +273,52 @@ class Archive : public Library_base
 
   struct Archive_header;
 
+  // The header of a file in the archive index cache.
+  struct Index_cache_header;
+
   // Total number of archives seen.
   static unsigned int total_archives;
   // Total number of archive members seen.
   static unsigned int total_members;
   // Number of archive members loaded.
   static unsigned int total_members_loaded;
+  // Number of archives found in the archive index cache.
+  static unsigned int total_index_cache_hits;
 
   // Get a view into the underlying file.
   const unsigned char*
   get_view(off_t start, section_size_type size, bool aligned, bool cache)
   { return this->input_file_->file().get_view(0, start, size, aligned, cache); }
 
+  // Read the symbol map and the extended name table from the archive.
+  // Return whether the archive has a symbol map.
+  bool
+  read_symbol_map_and_names();
+
   // Read the archive symbol map.
   void
   read_armap(off_t start, section_size_type size);
 
+  // Set *KEY to identify the archive in the archive index cache in
+  // DIR, and set *CACHE_NAME to the name of its cache file.  Return
+  // false if the archive can not be identified.
+  bool
+  index_cache_key(const char* dir, Index_cache_header* key,
+		  std::string* cache_name);
+
+  // Read the symbol map and extended name table from the cache file
+  // CACHE_NAME.  Return false if the file does not exist or does not
+  // match KEY.
+  bool
+  read_index_cache(const std::string& cache_name,
+		   const Index_cache_header& key);
+
+  // Write the symbol map and extended name table to the cache file
+  // CACHE_NAME.
+  void
+  write_index_cache(const std::string& cache_name,
+		    const Index_cache_header& key) const;
+
   // Read an archive member header at OFF.  CACHE is whether to cache
   // the file view.  Return the size of the member, and set *PNAME to
   // the name.
@@ -323,6 +353,24 @@ class Archive : public Library_base
   void
   read_symbols(off_t off);
 
+  // Whether to read the symbols of the members needed by a pass of
+  // add_symbols on several threads.
+  bool
+  should_read_needed_members() const;
+
+  // Find the armap entries whose name no other member defines.
+  void
+  find_unique_armap_names();
+
+  // Read the symbols of the members which define a symbol that the
+  // link needs now, on several threads.
+  void
+  read_needed_members(Symbol_table*, Layout*, char** tmpbufp,
+		      size_t* tmpbuflen);
+
+  // Reads the symbols of archive members on several threads.
+  class Member_reader;
+
   // Include all the archive members in the link.
   bool
   include_all_members(Symbol_table*, Layout*, Input_objects*, Mapfile*);
@@ -385,6 +433,9 @@ class Archive : public Library_base
   // Track which symbols in the archive map are for elements which are
   // defined or which have already been included in the link.
   std::vector<bool> armap_checked_;
+  // For each symbol in the archive map, whether no other element
+  // defines a symbol of that name.  Set up by read_needed_members.
+  std::vector<bool> armap_unique_;
   // Track which elements have been included by offset.
   Unordered_set<off_t, Seen_hash> seen_offsets_;
   // Table of objects whose symbols have been pre-read.
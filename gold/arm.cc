@@ -51,6 +51,8 @@
 #include "gc.h"
 #include "attributes.h"
 #include "arm-reloc-property.h"
+#include "merge.h"
+#include "workqueue.h"
 
 namespace
 {
@@ -1475,6 +1477,72 @@ class Arm_exidx_input_section
   bool has_errors_;
 };
 
+// Stub_request class.  This records a relocation stub, or a Cortex-A8
+// branch record, needed by a branch found while scanning the relocations
+// of an object.  The objects are scanned in parallel, so the stubs are
+// added to the stub tables afterwards, in object order.
+
+class Stub_request
+{
+ public:
+  Stub_request(const Reloc_stub::Key& key, unsigned int r_type,
+	       unsigned int data_shndx, Arm_address address,
+	       Arm_address destination, bool is_cortex_a8_branch)
+    : key_(key), r_type_(r_type), data_shndx_(data_shndx),
+      address_(address), destination_(destination),
+      is_cortex_a8_branch_(is_cortex_a8_branch)
+  { }
+
+  // Accessors:  This is a read-only class.
+
+  // Return the key of the stub.  The stub type is arm_stub_none if
+  // only a Cortex-A8 branch record is needed.
+  const Reloc_stub::Key&
+  key() const
+  { return this->key_; }
+
+  // Return the relocation type.
+  unsigned int
+  r_type() const
+  { return this->r_type_; }
+
+  // Return the index of the section containing the branch.
+  unsigned int
+  data_shndx() const
+  { return this->data_shndx_; }
+
+  // Return the address of the branch.
+  Arm_address
+  address() const
+  { return this->address_; }
+
+  // Return the destination address of the branch.  LSB stores the THUMB
+  // bit.
+  Arm_address
+  destination() const
+  { return this->destination_; }
+
+  // Whether the branch needs a record for the Cortex-A8 erratum fix.
+  bool
+  is_cortex_a8_branch() const
+  { return this->is_cortex_a8_branch_; }
+
+ private:
+  // Key of the stub.
+  Reloc_stub::Key key_;
+  // Relocation type.
+  unsigned int r_type_;
+  // Index of the section containing the branch.
+  unsigned int data_shndx_;
+  // Address of the branch.
+  Arm_address address_;
+  // Destination address of the branch.  LSB is used to distinguish
+  // ARM/THUMB mode.
+  Arm_address destination_;
+  // Whether the branch needs a Cortex-A8 branch record.
+  bool is_cortex_a8_branch_;
+};
+
 // Arm_relobj class.
 
 template<bool big_endian>
@@ -1489,6 +1557,7 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
       stub_tables_(), local_symbol_is_thumb_function_(),
       attributes_section_data_(NULL), mapping_symbols_info_(),
       section_has_cortex_a8_workaround_(NULL), exidx_section_map_(),
+      branch_reloc_sections_(), stub_requests_(), cortex_a8_sections_(),
       output_local_symbol_count_needs_update_(false),
       merge_flags_and_attributes_(true)
   { }
@@ -1521,11 +1590,97 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
     return this->local_symbol_is_thumb_function_[r_sym];
   }
   
-  // Scan all relocation sections for stub generation.
+  // A branch relocation which may need a stub.  OFFSET is the offset of
+  // the branch in the output view of its section.  ADDRESS, DESTINATION
+  // and STUB_TYPE are the results of the last scan for stubs.  There may
+  // be millions of these, so they are kept small.
+  struct Branch_reloc
+  {
+    Branch_reloc(uint32_t offset_, unsigned int r_sym_,
+		 unsigned int r_type_, int32_t addend_, bool is_discarded_)
+      : offset(offset_), r_sym(r_sym_), addend(addend_),
+	address(invalid_address), destination(invalid_address),
+	r_type(r_type_), stub_type(arm_stub_none),
+	is_discarded(is_discarded_)
+    { }
+
+    uint32_t offset;
+    unsigned int r_sym;
+    int32_t addend;
+    Arm_address address;
+    Arm_address destination;
+    unsigned char r_type;
+    unsigned char stub_type;
+    // Whether the symbol is defined in a discarded section.
+    bool is_discarded;
+  };
+
+  // The branch relocations of a relocation section.
+  struct Branch_reloc_section
+  {
+    Branch_reloc_section(unsigned int reloc_shndx_, unsigned int data_shndx_)
+      : reloc_shndx(reloc_shndx_), data_shndx(data_shndx_),
+	comdat_behavior(CB_UNDETERMINED), relocs()
+    { }
+
+    unsigned int reloc_shndx;
+    unsigned int data_shndx;
+    // What to do with a branch to a discarded section.
+    Comdat_behavior comdat_behavior;
+    std::vector<Branch_reloc> relocs;
+  };
+
+  // Find the relocations which may need stubs.  This is done on the
+  // first relaxation pass, and reads the object, so it must be locked.
+  void
+  find_branch_relocs(Target_arm<big_endian>*, const Symbol_table*,
+		     const Layout*);
+
+  // Scan the relocations found by find_branch_relocs for stub
+  // generation, and record the stubs needed in the stub requests.
+  // This does not read the object or change the stub tables, so the
+  // objects may be scanned in parallel.
   void
   scan_sections_for_stubs(Target_arm<big_endian>*, const Symbol_table*,
 			  const Layout*);
 
+  // Find the sections to scan for the Cortex-A8 erratum, and get views
+  // of their contents.  The object must be locked.
+  void
+  find_cortex_a8_sections(const Symbol_table*);
+
+  // Return the number of sections found by find_cortex_a8_sections.
+  size_t
+  cortex_a8_section_count() const
+  { return this->cortex_a8_sections_.size(); }
+
+  // Scan the Ith section found by find_cortex_a8_sections for the
+  // Cortex-A8 erratum, and record the stubs needed.  This does not read
+  // the object or change the stub tables, so the sections may be
+  // scanned in parallel.
+  void
+  scan_section_for_cortex_a8_erratum(size_t i, Target_arm<big_endian>*);
+
+  // Add the Cortex-A8 stubs recorded by the scan to the stub tables, and
+  // release the section views.  The object must be locked.
+  void
+  add_cortex_a8_stubs();
+
+  // Record a stub needed by a branch in this object.
+  void
+  add_stub_request(const Stub_request& request)
+  { this->stub_requests_.push_back(request); }
+
+  // Return the stubs needed by the last scan for stubs.
+  const std::vector<Stub_request>&
+  stub_requests() const
+  { return this->stub_requests_; }
+
+  // Clear the stub requests once the stubs have been added.
+  void
+  clear_stub_requests()
+  { this->stub_requests_.clear(); }
+
   // Convert regular input section with index SHNDX to a relaxed section.
   void
   convert_input_section_to_relaxed_section(unsigned shndx)
@@ -1684,6 +1839,23 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
 
  private:
 
+  // A section to scan for the Cortex-A8 erratum.  VIEW holds the section
+  // contents, and STUBS the stubs found by the scan, in address order.
+  struct Cortex_a8_section
+  {
+    Cortex_a8_section(unsigned int shndx_, section_size_type size_,
+		      Arm_address output_address_, File_view* view_)
+      : shndx(shndx_), size(size_), output_address(output_address_),
+	view(view_), stubs()
+    { }
+
+    unsigned int shndx;
+    section_size_type size;
+    Arm_address output_address;
+    File_view* view;
+    std::vector<Cortex_a8_stub*> stubs;
+  };
+
   // Whether a section needs to be scanned for relocation stubs.
   bool
   section_needs_reloc_stub_scanning(const elfcpp::Shdr<32, big_endian>&,
@@ -1701,12 +1873,6 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
 					unsigned int, Output_section*,
 					const Symbol_table*);
 
-  // Scan a section for the Cortex-A8 erratum.
-  void
-  scan_section_for_cortex_a8_erratum(const elfcpp::Shdr<32, big_endian>&,
-				     unsigned int, Output_section*,
-				     Target_arm<big_endian>*);
-
   // Find the linked text section of an EXIDX section by looking at the
   // first reloction of the EXIDX section.  PSHDR points to the section
   // headers of a relocation section and PSYMS points to the local symbols.
@@ -1750,6 +1916,12 @@ class Arm_relobj : public Sized_relobj_file<32, big_endian>
   std::vector<bool>* section_has_cortex_a8_workaround_;
   // Map a text section to its associated .ARM.exidx section, if there is one.
   Exidx_section_map exidx_section_map_;
+  // Branch relocations which may need stubs, by relocation section.
+  std::vector<Branch_reloc_section> branch_reloc_sections_;
+  // Stubs needed by the last scan for stubs.
+  std::vector<Stub_request> stub_requests_;
+  // Sections to scan for the Cortex-A8 erratum.
+  std::vector<Cortex_a8_section> cortex_a8_sections_;
   // Whether output local symbol count needs updating.
   bool output_local_symbol_count_needs_update_;
   // Whether we merge processor flags and attributes of this object to
@@ -2431,12 +2603,19 @@ class Target_arm : public Sized_target<32, big_endian>
   Stub_table<big_endian>*
   new_stub_table(Arm_input_section<big_endian>*);
 
-  // Scan a section for stub generation.
+  // Find the relocations in a relocation section which may need stubs.
   void
-  scan_section_for_stubs(const Relocate_info<32, big_endian>*, unsigned int,
-			 const unsigned char*, size_t, Output_section*,
-			 bool, const unsigned char*, Arm_address,
-			 section_size_type);
+  find_branch_relocs(const Relocate_info<32, big_endian>*, unsigned int,
+		     const unsigned char*, size_t, Output_section*, bool,
+		     const unsigned char*, section_size_type,
+		     typename Arm_relobj<big_endian>::Branch_reloc_section*);
+
+  // Scan the branch relocations of a section for stub generation.
+  void
+  scan_branch_relocs_for_stubs(
+      const Relocate_info<32, big_endian>*,
+      typename Arm_relobj<big_endian>::Branch_reloc_section*,
+      Arm_address);
 
   // Relocate a stub. 
   void
@@ -2486,7 +2665,8 @@ class Target_arm : public Sized_target<32, big_endian>
   void
   scan_span_for_cortex_a8_erratum(Arm_relobj<big_endian>*, unsigned int,
 				  section_size_type, section_size_type,
-				  const unsigned char*, Arm_address);
+				  const unsigned char*, Arm_address,
+				  std::vector<Cortex_a8_stub*>*);
 
   // Apply Cortex-A8 workaround to a branch.
   void
@@ -2846,20 +3026,31 @@ class Target_arm : public Sized_target<32, big_endian>
   scan_reloc_for_stub(const Relocate_info<32, big_endian>*, unsigned int,
 		      const Sized_symbol<32>*, unsigned int,
 		      const Symbol_value<32>*,
-		      elfcpp::Elf_types<32>::Elf_Swxword, Arm_address);
+		      elfcpp::Elf_types<32>::Elf_Swxword, Arm_address,
+		      typename Arm_relobj<big_endian>::Branch_reloc*);
 
-  // Scan a relocation section for stub.
+  // Find the relocations in a relocation section which may need stubs.
   template<int sh_type>
   void
-  scan_reloc_section_for_stubs(
+  find_branch_relocs_in_section(
       const Relocate_info<32, big_endian>* relinfo,
       const unsigned char* prelocs,
       size_t reloc_count,
       Output_section* output_section,
       bool needs_special_offset_handling,
       const unsigned char* view,
-      elfcpp::Elf_types<32>::Elf_Addr view_address,
-      section_size_type);
+      section_size_type,
+      typename Arm_relobj<big_endian>::Branch_reloc_section*);
+
+  // Add the stubs requested by the last scan of an object.
+  void
+  add_requested_stubs(Arm_relobj<big_endian>*);
+
+  // Scans objects for stubs in parallel.
+  class Stub_scanner;
+
+  // Scans sections for the Cortex-A8 erratum in parallel.
+  class Cortex_a8_scanner;
 
   // Fix .ARM.exidx section coverage.
   void
@@ -4274,6 +4465,13 @@ Target_arm<big_endian>::rel_dyn_section(Layout* layout)
       layout->add_output_section_data(".rel.dyn", elfcpp::SHT_REL,
 				      elfcpp::SHF_ALLOC, this->rel_dyn_,
 				      ORDER_DYNAMIC_RELOCS, false);
+      if (parameters->options().pack_relative_relocs())
+	{
+	  Output_data_relr<32, big_endian>* relr =
+	    new Output_data_relr<32, big_endian>();
+	  layout->add_relr_dyn_section(relr);
+	  this->rel_dyn_->set_relr_section(relr, elfcpp::R_ARM_RELATIVE);
+	}
     }
   return this->rel_dyn_;
 }
@@ -6172,41 +6370,27 @@ Arm_relobj<big_endian>::section_needs_cortex_a8_stub_scanning(
   return true;
 }
 
-// Scan a section for Cortex-A8 workaround.
+// Scan the Ith section found by find_cortex_a8_sections for the
+// Cortex-A8 workaround.
 
 template<bool big_endian>
 void
 Arm_relobj<big_endian>::scan_section_for_cortex_a8_erratum(
-    const elfcpp::Shdr<32, big_endian>& shdr,
-    unsigned int shndx,
-    Output_section* os,
+    size_t i,
     Target_arm<big_endian>* arm_target)
 {
-  // Look for the first mapping symbol in this section.  It should be
-  // at (shndx, 0).
+  Cortex_a8_section& section(this->cortex_a8_sections_[i]);
+  unsigned int shndx = section.shndx;
+  Arm_address output_address = section.output_address;
+  const unsigned char* input_view = section.view->data();
+
+  // find_cortex_a8_sections only keeps sections with mapping symbols.
+  // It should be at (shndx, 0).
   Mapping_symbol_position section_start(shndx, 0);
   typename Mapping_symbols_info::const_iterator p =
     this->mapping_symbols_info_.lower_bound(section_start);
-
-  // There are no mapping symbols for this section.  Treat it as a data-only
-  // section.  Issue a warning if section is marked as containing
-  // instructions.
-  if (p == this->mapping_symbols_info_.end() || p->first.first != shndx)
-    {
-      if ((this->section_flags(shndx) & elfcpp::SHF_EXECINSTR) != 0)
-	gold_warning(_("cannot scan executable section %u of %s for Cortex-A8 "
-		       "erratum because it has no mapping symbols."),
-		     shndx, this->name().c_str());
-      return;
-    }
-
-  Arm_address output_address =
-    this->simple_input_section_output_address(shndx, os);
-
-  // Get the section contents.
-  section_size_type input_view_size = 0;
-  const unsigned char* input_view =
-    this->section_contents(shndx, &input_view_size, false);
+  gold_assert(p != this->mapping_symbols_info_.end()
+	      && p->first.first == shndx);
 
   // We need to go through the mapping symbols to determine what to
   // scan.  There are two reasons.  First, we should look at THUMB code and
@@ -6230,7 +6414,7 @@ Arm_relobj<big_endian>::scan_section_for_cortex_a8_erratum(
 	      && next->first.first == shndx)
 	    span_end = convert_to_section_size_type(next->first.second);
 	  else
-	    span_end = convert_to_section_size_type(shdr.get_sh_size());
+	    span_end = section.size;
 	  
 	  if (((span_start + output_address) & ~0xfffUL)
 	      != ((span_end + output_address - 1) & ~0xfffUL))
@@ -6238,7 +6422,8 @@ Arm_relobj<big_endian>::scan_section_for_cortex_a8_erratum(
 	      arm_target->scan_span_for_cortex_a8_erratum(this, shndx,
 							  span_start, span_end,
 							  input_view,
-							  output_address);
+							  output_address,
+							  &section.stubs);
 	    }
 	}
 
@@ -6246,11 +6431,11 @@ Arm_relobj<big_endian>::scan_section_for_cortex_a8_erratum(
     }
 }
 
-// Scan relocations for stub generation.
+// Find the relocations which may need stubs.
 
 template<bool big_endian>
 void
-Arm_relobj<big_endian>::scan_sections_for_stubs(
+Arm_relobj<big_endian>::find_branch_relocs(
     Target_arm<big_endian>* arm_target,
     const Symbol_table* symtab,
     const Layout* layout)
@@ -6263,6 +6448,69 @@ Arm_relobj<big_endian>::scan_sections_for_stubs(
 					       shnum * shdr_size,
 					       true, true);
 
+  const Relobj::Output_sections& out_sections(this->output_sections());
+
+  Relocate_info<32, big_endian> relinfo;
+  relinfo.symtab = symtab;
+  relinfo.layout = layout;
+  relinfo.object = this;
+
+  const unsigned char* p = pshdrs + shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
+    {
+      const elfcpp::Shdr<32, big_endian> shdr(p);
+      if (!this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
+						   pshdrs))
+	continue;
+
+      unsigned int index = this->adjust_shndx(shdr.get_sh_info());
+      Arm_address output_offset = this->get_output_section_offset(index);
+
+      // Get the relocations.
+      const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
+						    shdr.get_sh_size(),
+						    true, false);
+
+      // Get the section contents.  This does work for the case in which
+      // we modify the contents of an input section.  We need to pass the
+      // output view under such circumstances.
+      section_size_type input_view_size = 0;
+      const unsigned char* input_view =
+	this->section_contents(index, &input_view_size, false);
+
+      relinfo.reloc_shndx = i;
+      relinfo.data_shndx = index;
+      unsigned int sh_type = shdr.get_sh_type();
+      unsigned int reloc_size;
+      if (sh_type == elfcpp::SHT_REL)
+	reloc_size = elfcpp::Elf_sizes<32>::rel_size;
+      else
+	reloc_size = elfcpp::Elf_sizes<32>::rela_size;
+
+      this->branch_reloc_sections_.push_back(Branch_reloc_section(i, index));
+      Branch_reloc_section* brs = &this->branch_reloc_sections_.back();
+      arm_target->find_branch_relocs(&relinfo, sh_type, prelocs,
+				     shdr.get_sh_size() / reloc_size,
+				     out_sections[index],
+				     output_offset == invalid_address,
+				     input_view, input_view_size, brs);
+      if (brs->relocs.empty())
+	this->branch_reloc_sections_.pop_back();
+    }
+}
+
+// Scan relocations for stub generation.
+
+template<bool big_endian>
+void
+Arm_relobj<big_endian>::scan_sections_for_stubs(
+    Target_arm<big_endian>* arm_target,
+    const Symbol_table* symtab,
+    const Layout* layout)
+{
+  if (this->branch_reloc_sections_.empty())
+    return;
+
   // To speed up processing, we set up hash tables for fast lookup of
   // input offsets to output addresses.
   this->initialize_input_to_output_maps();
@@ -6274,81 +6522,114 @@ Arm_relobj<big_endian>::scan_sections_for_stubs(
   relinfo.layout = layout;
   relinfo.object = this;
 
-  // Do relocation stubs scanning.
+  for (typename std::vector<Branch_reloc_section>::iterator p =
+	 this->branch_reloc_sections_.begin();
+       p != this->branch_reloc_sections_.end();
+       ++p)
+    {
+      relinfo.reloc_shndx = p->reloc_shndx;
+      relinfo.data_shndx = p->data_shndx;
+      Arm_address output_address =
+	this->simple_input_section_output_address(p->data_shndx,
+						  out_sections[p->data_shndx]);
+      arm_target->scan_branch_relocs_for_stubs(&relinfo, &*p, output_address);
+    }
+
+  // After we've done the relocations, we release the hash tables,
+  // since we no longer need them.
+  this->free_input_to_output_maps();
+}
+
+// Find the sections to scan for the Cortex-A8 erratum.  This has to be
+// done for a section after its relocation section, if there is one, is
+// scanned for relocation stubs, and the stubs are added.  The section
+// contents are kept in lasting views, so that they may be scanned
+// without the object locked.
+
+template<bool big_endian>
+void
+Arm_relobj<big_endian>::find_cortex_a8_sections(const Symbol_table* symtab)
+{
+  gold_assert(this->cortex_a8_sections_.empty());
+
+  unsigned int shnum = this->shnum();
+  const unsigned int shdr_size = elfcpp::Elf_sizes<32>::shdr_size;
+
+  // Read the section headers.
+  const unsigned char* pshdrs = this->get_view(this->elf_file()->shoff(),
+					       shnum * shdr_size,
+					       true, true);
+
+  const Relobj::Output_sections& out_sections(this->output_sections());
+
   const unsigned char* p = pshdrs + shdr_size;
   for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
     {
       const elfcpp::Shdr<32, big_endian> shdr(p);
-      if (this->section_needs_reloc_stub_scanning(shdr, out_sections, symtab,
-						  pshdrs))
-	{
-	  unsigned int index = this->adjust_shndx(shdr.get_sh_info());
-	  Arm_address output_offset = this->get_output_section_offset(index);
-	  Arm_address output_address;
-	  if (output_offset != invalid_address)
-	    output_address = out_sections[index]->address() + output_offset;
-	  else
-	    {
-	      // Currently this only happens for a relaxed section.
-	      const Output_relaxed_input_section* poris =
-	      out_sections[index]->find_relaxed_input_section(this, index);
-	      gold_assert(poris != NULL);
-	      output_address = poris->address();
-	    }
+      if (!this->section_needs_cortex_a8_stub_scanning(shdr, i,
+						       out_sections[i],
+						       symtab))
+	continue;
 
-	  // Get the relocations.
-	  const unsigned char* prelocs = this->get_view(shdr.get_sh_offset(),
-							shdr.get_sh_size(),
-							true, false);
-
-	  // Get the section contents.  This does work for the case in which
-	  // we modify the contents of an input section.  We need to pass the
-	  // output view under such circumstances.
-	  section_size_type input_view_size = 0;
-	  const unsigned char* input_view =
-	    this->section_contents(index, &input_view_size, false);
-
-	  relinfo.reloc_shndx = i;
-	  relinfo.data_shndx = index;
-	  unsigned int sh_type = shdr.get_sh_type();
-	  unsigned int reloc_size;
-	  if (sh_type == elfcpp::SHT_REL)
-	    reloc_size = elfcpp::Elf_sizes<32>::rel_size;
-	  else
-	    reloc_size = elfcpp::Elf_sizes<32>::rela_size;
-
-	  Output_section* os = out_sections[index];
-	  arm_target->scan_section_for_stubs(&relinfo, sh_type, prelocs,
-					     shdr.get_sh_size() / reloc_size,
-					     os,
-					     output_offset == invalid_address,
-					     input_view, output_address,
-					     input_view_size);
+      // There are no mapping symbols for this section.  Treat it as a
+      // data-only section.  Issue a warning if section is marked as
+      // containing instructions.
+      Mapping_symbol_position section_start(i, 0);
+      typename Mapping_symbols_info::const_iterator q =
+	this->mapping_symbols_info_.lower_bound(section_start);
+      if (q == this->mapping_symbols_info_.end() || q->first.first != i)
+	{
+	  if ((shdr.get_sh_flags() & elfcpp::SHF_EXECINSTR) != 0)
+	    gold_warning(_("cannot scan executable section %u of %s for "
+			   "Cortex-A8 erratum because it has no mapping "
+			   "symbols."),
+			 i, this->name().c_str());
+	  continue;
 	}
+
+      Arm_address output_address =
+	this->simple_input_section_output_address(i, out_sections[i]);
+      section_size_type size =
+	convert_to_section_size_type(shdr.get_sh_size());
+      File_view* view = this->get_lasting_view(shdr.get_sh_offset(), size,
+					       true, false);
+      this->cortex_a8_sections_.push_back(Cortex_a8_section(i, size,
+							    output_address,
+							    view));
     }
+}
+
+// Add the Cortex-A8 stubs found by the last scan to the stub tables.
+// The stubs of each section were found in address order, and the
+// sections are in index order, so the stubs are added in the same order
+// as a serial scan.
 
-  // Do Cortex-A8 erratum stubs scanning.  This has to be done for a section
-  // after its relocation section, if there is one, is processed for
-  // relocation stubs.  Merging this loop with the one above would have been
-  // complicated since we would have had to make sure that relocation stub
-  // scanning is done first.
-  if (arm_target->fix_cortex_a8())
+template<bool big_endian>
+void
+Arm_relobj<big_endian>::add_cortex_a8_stubs()
+{
+  for (typename std::vector<Cortex_a8_section>::iterator p =
+	 this->cortex_a8_sections_.begin();
+       p != this->cortex_a8_sections_.end();
+       ++p)
     {
-      const unsigned char* p = pshdrs + shdr_size;
-      for (unsigned int i = 1; i < shnum; ++i, p += shdr_size)
+      if (!p->stubs.empty())
 	{
-	  const elfcpp::Shdr<32, big_endian> shdr(p);
-	  if (this->section_needs_cortex_a8_stub_scanning(shdr, i,
-							  out_sections[i],
-							  symtab))
-	    this->scan_section_for_cortex_a8_erratum(shdr, i, out_sections[i],
-						     arm_target);
+	  Stub_table<big_endian>* stub_table = this->stub_table(p->shndx);
+	  gold_assert(stub_table != NULL);
+	  for (typename std::vector<Cortex_a8_stub*>::const_iterator q =
+		 p->stubs.begin();
+	       q != p->stubs.end();
+	       ++q)
+	    {
+	      // The source address of a stub has the THUMB bit set.
+	      Arm_address address = (*q)->source_address() & ~1U;
+	      stub_table->add_cortex_a8_stub(address, *q);
+	    }
 	}
+      delete p->view;
     }
-
-  // After we've done the relocations, we release the hash tables,
-  // since we no longer need them.
-  this->free_input_to_output_maps();
+  this->cortex_a8_sections_.clear();
 }
 
 // Count the local symbols.  The ARM backend needs to know if a symbol
@@ -10911,7 +11192,11 @@ Target_arm<big_endian>::new_stub_table(Arm_input_section<big_endian>* owner)
   return stub_table;
 }
 
-// Scan a relocation for stub generation.
+// Scan a relocation for stub generation.  BRANCH_RELOC holds the results
+// of the last scan of this relocation.  A stub is only requested if the
+// address or destination of the branch has changed since then, or if the
+// branch needs a Cortex-A8 record, since those are discarded on each
+// relaxation pass.
 
 template<bool big_endian>
 void
@@ -10922,11 +11207,12 @@ Target_arm<big_endian>::scan_reloc_for_stub(
     unsigned int r_sym,
     const Symbol_value<32>* psymval,
     elfcpp::Elf_types<32>::Elf_Swxword addend,
-    Arm_address address)
+    Arm_address address,
+    typename Arm_relobj<big_endian>::Branch_reloc* branch_reloc)
 {
   typedef typename Target_arm<big_endian>::Relocate Relocate;
 
-  const Arm_relobj<big_endian>* arm_relobj =
+  Arm_relobj<big_endian>* arm_relobj =
     Arm_relobj<big_endian>::as_arm_relobj(relinfo->object);
 
   bool target_is_thumb;
@@ -10973,7 +11259,7 @@ Target_arm<big_endian>::scan_reloc_for_stub(
 	psymval->value(arm_relobj, 0) & ~static_cast<Arm_address>(1);
       symval.set_output_value(stripped_value);
       psymval = &symval;
-    } 
+    }
 
   // Get the symbol value.
   Symbol_value<32>::Value value = psymval->value(arm_relobj, 0);
@@ -11000,55 +11286,89 @@ Target_arm<big_endian>::scan_reloc_for_stub(
       gold_unreachable();
     }
 
-  Reloc_stub* stub = NULL;
   Stub_type stub_type =
     Reloc_stub::stub_type_for_reloc(r_type, address, destination,
 				    target_is_thumb);
-  if (stub_type != arm_stub_none)
-    {
-      // Try looking up an existing stub from a stub table.
-      Stub_table<big_endian>* stub_table = 
-	arm_relobj->stub_table(relinfo->data_shndx);
-      gold_assert(stub_table != NULL);
-   
-      // Locate stub by destination.
-      Reloc_stub::Key stub_key(stub_type, gsym, arm_relobj, r_sym, addend);
-
-      // Create a stub if there is not one already
-      stub = stub_table->find_reloc_stub(stub_key);
-      if (stub == NULL)
+  destination |= (target_is_thumb ? 1 : 0);
+
+  // For Cortex-A8, we need to record a relocation at 4K page boundary.
+  // Note we don't check the destination is within 4K here: if we do so
+  // (and don't create a record) we can't tell that a branch should have
+  // been relocated when scanning later.
+  bool is_cortex_a8_branch =
+    (this->fix_cortex_a8_
+     && (r_type == elfcpp::R_ARM_THM_JUMP24
+	 || r_type == elfcpp::R_ARM_THM_JUMP19
+	 || r_type == elfcpp::R_ARM_THM_CALL
+	 || r_type == elfcpp::R_ARM_THM_XPC22)
+     && (address & 0xfffU) == 0xffeU);
+
+  // If nothing has changed since the last scan, any stub this branch
+  // needs already exists with the right destination.
+  if (address == branch_reloc->address
+      && destination == branch_reloc->destination
+      && stub_type == static_cast<Stub_type>(branch_reloc->stub_type)
+      && !is_cortex_a8_branch)
+    return;
+  branch_reloc->address = address;
+  branch_reloc->destination = destination;
+  branch_reloc->stub_type = stub_type;
+
+  if (stub_type == arm_stub_none && !is_cortex_a8_branch)
+    return;
+
+  Reloc_stub::Key stub_key(stub_type, gsym, arm_relobj, r_sym, addend);
+  arm_relobj->add_stub_request(Stub_request(stub_key, r_type,
+					    relinfo->data_shndx, address,
+					    destination,
+					    is_cortex_a8_branch));
+}
+
+// Add the stubs requested by the last scan of ARM_RELOBJ to the stub
+// tables.  This is done on one thread, in object order, so that the
+// stub tables do not depend on the number of threads.
+
+template<bool big_endian>
+void
+Target_arm<big_endian>::add_requested_stubs(Arm_relobj<big_endian>* arm_relobj)
+{
+  const std::vector<Stub_request>& requests(arm_relobj->stub_requests());
+  for (std::vector<Stub_request>::const_iterator p = requests.begin();
+       p != requests.end();
+       ++p)
+    {
+      Reloc_stub* stub = NULL;
+      if (p->key().stub_type() != arm_stub_none)
 	{
-	  // create a new stub and add it to stub table.
-	  stub = this->stub_factory().make_reloc_stub(stub_type);
-	  stub_table->add_reloc_stub(stub, stub_key);
-	}
+	  // Try looking up an existing stub from a stub table.
+	  Stub_table<big_endian>* stub_table =
+	    arm_relobj->stub_table(p->data_shndx());
+	  gold_assert(stub_table != NULL);
 
-      // Record the destination address.
-      stub->set_destination_address(destination
-				    | (target_is_thumb ? 1 : 0));
-    }
+	  // Create a stub if there is not one already
+	  stub = stub_table->find_reloc_stub(p->key());
+	  if (stub == NULL)
+	    {
+	      // create a new stub and add it to stub table.
+	      stub =
+		this->stub_factory().make_reloc_stub(p->key().stub_type());
+	      stub_table->add_reloc_stub(stub, p->key());
+	    }
 
-  // For Cortex-A8, we need to record a relocation at 4K page boundary.
-  if (this->fix_cortex_a8_
-      && (r_type == elfcpp::R_ARM_THM_JUMP24
-	  || r_type == elfcpp::R_ARM_THM_JUMP19
-	  || r_type == elfcpp::R_ARM_THM_CALL
-	  || r_type == elfcpp::R_ARM_THM_XPC22)
-      && (address & 0xfffU) == 0xffeU)
-    {
-      // Found a candidate.  Note we haven't checked the destination is
-      // within 4K here: if we do so (and don't create a record) we can't
-      // tell that a branch should have been relocated when scanning later.
-      this->cortex_a8_relocs_info_[address] =
-	new Cortex_a8_reloc(stub, r_type,
-			    destination | (target_is_thumb ? 1 : 0));
+	  // Record the destination address.
+	  stub->set_destination_address(p->destination());
+	}
+
+      if (p->is_cortex_a8_branch())
+	this->cortex_a8_relocs_info_[p->address()] =
+	  new Cortex_a8_reloc(stub, p->r_type(), p->destination());
     }
+  arm_relobj->clear_stub_requests();
 }
 
-// This function scans a relocation sections for stub generation.
-// The template parameter Relocate must be a class type which provides
-// a single function, relocate(), which implements the machine
-// specific part of a relocation.
+// This function finds the relocations in a relocation section which may
+// need stubs, and creates any V4BX stubs needed.  It is called on the
+// first relaxation pass.
 
 // BIG_ENDIAN is the endianness of the data.  SH_TYPE is the section type:
 // SHT_REL or SHT_RELA.
@@ -11058,25 +11378,24 @@ Target_arm<big_endian>::scan_reloc_for_stub(
 // NEEDS_SPECIAL_OFFSET_HANDLING is true if input offsets need to be
 // mapped to output offsets.
 
-// VIEW is the section data, VIEW_ADDRESS is its memory address, and
-// VIEW_SIZE is the size.  These refer to the input section, unless
-// NEEDS_SPECIAL_OFFSET_HANDLING is true, in which case they refer to
-// the output section.
+// VIEW is the section data.  The branch relocations are added to
+// BRANCH_RELOCS.
 
 template<bool big_endian>
 template<int sh_type>
 void inline
-Target_arm<big_endian>::scan_reloc_section_for_stubs(
+Target_arm<big_endian>::find_branch_relocs_in_section(
     const Relocate_info<32, big_endian>* relinfo,
     const unsigned char* prelocs,
     size_t reloc_count,
     Output_section* output_section,
     bool needs_special_offset_handling,
     const unsigned char* view,
-    elfcpp::Elf_types<32>::Elf_Addr view_address,
-    section_size_type)
+    section_size_type,
+    typename Arm_relobj<big_endian>::Branch_reloc_section* branch_relocs)
 {
   typedef typename Reloc_types<sh_type, 32, big_endian>::Reloc Reltype;
+  typedef typename Arm_relobj<big_endian>::Branch_reloc Branch_reloc;
   const int reloc_size =
     Reloc_types<sh_type, 32, big_endian>::reloc_size;
 
@@ -11084,8 +11403,6 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
     Arm_relobj<big_endian>::as_arm_relobj(relinfo->object);
   unsigned int local_count = arm_object->local_symbol_count();
 
-  Comdat_behavior comdat_behavior = CB_UNDETERMINED;
-
   for (size_t i = 0; i < reloc_count; ++i, prelocs += reloc_size)
     {
       Reltype reloc(prelocs);
@@ -11119,7 +11436,8 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 	    continue;
 	}
 
-      // Create a v4bx stub if --fix-v4bx-interworking is used.
+      // Create a v4bx stub if --fix-v4bx-interworking is used.  These
+      // do not depend on addresses, so this is only done once.
       if (r_type == elfcpp::R_ARM_V4BX)
 	{
 	  if (this->fix_v4bx() == General_options::FIX_V4BX_INTERWORKING)
@@ -11157,57 +11475,168 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
       elfcpp::Elf_types<32>::Elf_Swxword addend =
 	stub_addend_reader(r_type, view + offset, reloc);
 
-      const Sized_symbol<32>* sym;
-
-      Symbol_value<32> symval;
-      const Symbol_value<32> *psymval;
       bool is_defined_in_discarded_section;
-      unsigned int shndx;
       if (r_sym < local_count)
 	{
-	  sym = NULL;
-	  psymval = arm_object->local_symbol(r_sym);
-
           // If the local symbol belongs to a section we are discarding,
           // and that section is a debug section, try to find the
           // corresponding kept section and map this symbol to its
-          // counterpart in the kept section.  The symbol must not 
+          // counterpart in the kept section.  The symbol must not
           // correspond to a section we are folding.
 	  bool is_ordinary;
-	  shndx = psymval->input_shndx(&is_ordinary);
+	  unsigned int shndx =
+	    arm_object->local_symbol(r_sym)->input_shndx(&is_ordinary);
 	  is_defined_in_discarded_section =
 	    (is_ordinary
 	     && shndx != elfcpp::SHN_UNDEF
 	     && !arm_object->is_section_included(shndx)
 	     && !relinfo->symtab->is_section_folded(arm_object, shndx));
 
+	  // Currently we cannot handle a branch to a target in a merged
+	  // section.  If this is the case, issue an error.  This is done
+	  // here because the section name can not be read later, when the
+	  // objects are scanned in parallel.
+	  const Symbol_value<32>* psymval = arm_object->local_symbol(r_sym);
+	  if (!is_defined_in_discarded_section
+	      && psymval->is_section_symbol())
+	    {
+	      typedef Sized_relobj_file<32, big_endian> ObjType;
+	      Symbol_value<32> symval;
+	      typename ObjType::Compute_final_local_value_status status =
+		arm_object->compute_final_local_value(r_sym, psymval, &symval,
+						      relinfo->symtab);
+	      if (status == ObjType::CFLV_OK && !symval.has_output_value())
+		{
+		  const std::string& section_name =
+		    arm_object->section_name(shndx);
+		  arm_object->error(_("cannot handle branch to local %u "
+				      "in a merged section %s"),
+				    r_sym, section_name.c_str());
+		}
+	    }
+	}
+      else
+	{
+	  const Symbol* gsym = arm_object->global_symbol(r_sym);
+	  gold_assert(gsym != NULL);
+	  if (gsym->is_forwarder())
+	    gsym = relinfo->symtab->resolve_forwards(gsym);
+	  is_defined_in_discarded_section =
+	    (gsym->is_defined_in_discarded_section()
+	     && gsym->is_undefined());
+	}
+
+      if (is_defined_in_discarded_section)
+	{
+	  if (branch_relocs->comdat_behavior == CB_UNDETERMINED)
+	    {
+	      std::string name = arm_object->section_name(relinfo->data_shndx);
+	      branch_relocs->comdat_behavior =
+		get_comdat_behavior(name.c_str());
+	    }
+	  if (branch_relocs->comdat_behavior == CB_WARNING)
+	    gold_warning_at_location(relinfo, i, offset,
+				     _("relocation refers to discarded "
+				       "section"));
+	}
+
+      branch_relocs->relocs.push_back(Branch_reloc(offset, r_sym, r_type,
+						   addend,
+						   is_defined_in_discarded_section));
+    }
+}
+
+// Find the relocations in a relocation section which may need stubs.
+
+template<bool big_endian>
+void
+Target_arm<big_endian>::find_branch_relocs(
+    const Relocate_info<32, big_endian>* relinfo,
+    unsigned int sh_type,
+    const unsigned char* prelocs,
+    size_t reloc_count,
+    Output_section* output_section,
+    bool needs_special_offset_handling,
+    const unsigned char* view,
+    section_size_type view_size,
+    typename Arm_relobj<big_endian>::Branch_reloc_section* branch_relocs)
+{
+  if (sh_type == elfcpp::SHT_REL)
+    this->find_branch_relocs_in_section<elfcpp::SHT_REL>(
+	relinfo,
+	prelocs,
+	reloc_count,
+	output_section,
+	needs_special_offset_handling,
+	view,
+	view_size,
+	branch_relocs);
+  else if (sh_type == elfcpp::SHT_RELA)
+    // We do not support RELA type relocations yet.  This is provided for
+    // completeness.
+    this->find_branch_relocs_in_section<elfcpp::SHT_RELA>(
+	relinfo,
+	prelocs,
+	reloc_count,
+	output_section,
+	needs_special_offset_handling,
+	view,
+	view_size,
+	branch_relocs);
+  else
+    gold_unreachable();
+}
+
+// Scan the branch relocations in BRANCH_RELOCS for stub generation.
+// VIEW_ADDRESS is the output address of the section containing them.
+
+template<bool big_endian>
+void
+Target_arm<big_endian>::scan_branch_relocs_for_stubs(
+    const Relocate_info<32, big_endian>* relinfo,
+    typename Arm_relobj<big_endian>::Branch_reloc_section* branch_relocs,
+    Arm_address view_address)
+{
+  typedef typename Arm_relobj<big_endian>::Branch_reloc Branch_reloc;
+
+  Arm_relobj<big_endian>* arm_object =
+    Arm_relobj<big_endian>::as_arm_relobj(relinfo->object);
+  unsigned int local_count = arm_object->local_symbol_count();
+
+  for (typename std::vector<Branch_reloc>::iterator p =
+	 branch_relocs->relocs.begin();
+       p != branch_relocs->relocs.end();
+       ++p)
+    {
+      unsigned int r_sym = p->r_sym;
+      const Sized_symbol<32>* sym;
+
+      Symbol_value<32> symval;
+      const Symbol_value<32> *psymval;
+      unsigned int shndx;
+      if (r_sym < local_count)
+	{
+	  sym = NULL;
+	  psymval = arm_object->local_symbol(r_sym);
+	  bool is_ordinary;
+	  shndx = psymval->input_shndx(&is_ordinary);
+
 	  // We need to compute the would-be final value of this local
 	  // symbol.
-	  if (!is_defined_in_discarded_section)
+	  if (!p->is_discarded)
 	    {
 	      typedef Sized_relobj_file<32, big_endian> ObjType;
 	      typename ObjType::Compute_final_local_value_status status =
 		arm_object->compute_final_local_value(r_sym, psymval, &symval,
-						      relinfo->symtab); 
+						      relinfo->symtab);
+	      // A branch to a target in a merged section was reported by
+	      // find_branch_relocs_in_section.
 	      if (status == ObjType::CFLV_OK)
-		{
-		  // Currently we cannot handle a branch to a target in
-		  // a merged section.  If this is the case, issue an error
-		  // and also free the merge symbol value.
-		  if (!symval.has_output_value())
-		    {
-		      const std::string& section_name =
-			arm_object->section_name(shndx);
-		      arm_object->error(_("cannot handle branch to local %u "
-					  "in a merged section %s"),
-					r_sym, section_name.c_str());
-		    }
-		  psymval = &symval;
-		}
+		psymval = &symval;
 	      else
 		{
 		  // We cannot determine the final value.
-		  continue;  
+		  continue;
 		}
 	    }
 	}
@@ -11244,22 +11673,15 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 	  else if (gsym->type() == elfcpp::STT_GNU_IFUNC)
 	    symval.set_is_ifunc_symbol();
 	  psymval = &symval;
-
-	  is_defined_in_discarded_section =
-	    (gsym->is_defined_in_discarded_section()
-	     && gsym->is_undefined());
 	  shndx = 0;
 	}
 
+      // Any warning for a branch to a discarded section was given by
+      // find_branch_relocs_in_section.
       Symbol_value<32> symval2;
-      if (is_defined_in_discarded_section)
+      if (p->is_discarded)
 	{
-	  if (comdat_behavior == CB_UNDETERMINED)
-	    {
-	      std::string name = arm_object->section_name(relinfo->data_shndx);
-	      comdat_behavior = get_comdat_behavior(name.c_str());
-	    }
-	  if (comdat_behavior == CB_PRETEND)
+	  if (branch_relocs->comdat_behavior == CB_PRETEND)
 	    {
 	      // FIXME: This case does not work for global symbols.
 	      // We have no place to store the original section index.
@@ -11275,13 +11697,7 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
 		symval2.set_output_value(0);
 	    }
 	  else
-	    {
-	      if (comdat_behavior == CB_WARNING)
-		gold_warning_at_location(relinfo, i, offset,
-					 _("relocation refers to discarded "
-					   "section"));
-	      symval2.set_output_value(0);
-	    }
+	    symval2.set_output_value(0);
 	  symval2.set_no_output_symtab_entry();
 	  psymval = &symval2;
 	}
@@ -11291,51 +11707,67 @@ Target_arm<big_endian>::scan_reloc_section_for_stubs(
       if (psymval->is_section_symbol())
 	continue;
 
-      this->scan_reloc_for_stub(relinfo, r_type, sym, r_sym, psymval,
-				addend, view_address + offset);
+      this->scan_reloc_for_stub(relinfo, p->r_type, sym, r_sym, psymval,
+				p->addend, view_address + p->offset, &*p);
     }
 }
 
-// Scan an input section for stub generation.
+// Class Target_arm::Stub_scanner.  Part I of this scans the Ith object
+// for relocation stubs.
 
 template<bool big_endian>
-void
-Target_arm<big_endian>::scan_section_for_stubs(
-    const Relocate_info<32, big_endian>* relinfo,
-    unsigned int sh_type,
-    const unsigned char* prelocs,
-    size_t reloc_count,
-    Output_section* output_section,
-    bool needs_special_offset_handling,
-    const unsigned char* view,
-    Arm_address view_address,
-    section_size_type view_size)
+class Target_arm<big_endian>::Stub_scanner : public Parallel_runner
 {
-  if (sh_type == elfcpp::SHT_REL)
-    this->scan_reloc_section_for_stubs<elfcpp::SHT_REL>(
-	relinfo,
-	prelocs,
-	reloc_count,
-	output_section,
-	needs_special_offset_handling,
-	view,
-	view_address,
-	view_size);
-  else if (sh_type == elfcpp::SHT_RELA)
-    // We do not support RELA type relocations yet.  This is provided for
-    // completeness.
-    this->scan_reloc_section_for_stubs<elfcpp::SHT_RELA>(
-	relinfo,
-	prelocs,
-	reloc_count,
-	output_section,
-	needs_special_offset_handling,
-	view,
-	view_address,
-	view_size);
-  else
-    gold_unreachable();
-}
+ public:
+  Stub_scanner(Target_arm<big_endian>* target,
+	       const std::vector<Arm_relobj<big_endian>*>& objects,
+	       const Symbol_table* symtab, const Layout* layout)
+    : target_(target), objects_(objects), symtab_(symtab), layout_(layout)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    this->objects_[part]->scan_sections_for_stubs(this->target_,
+						  this->symtab_,
+						  this->layout_);
+  }
+
+ private:
+  Target_arm<big_endian>* target_;
+  const std::vector<Arm_relobj<big_endian>*>& objects_;
+  const Symbol_table* symtab_;
+  const Layout* layout_;
+};
+
+// Class Target_arm::Cortex_a8_scanner.  Part I of this scans the Ith
+// section in a list of (object, section) pairs for the Cortex-A8
+// erratum.  Sections are used as the parts, rather than objects, since
+// a few objects often hold most of the code.
+
+template<bool big_endian>
+class Target_arm<big_endian>::Cortex_a8_scanner : public Parallel_runner
+{
+ public:
+  typedef std::vector<std::pair<Arm_relobj<big_endian>*, size_t> >
+    Section_list;
+
+  Cortex_a8_scanner(Target_arm<big_endian>* target,
+		    const Section_list& sections)
+    : target_(target), sections_(sections)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    const std::pair<Arm_relobj<big_endian>*, size_t>& p(this->sections_[part]);
+    p.first->scan_section_for_cortex_a8_erratum(p.second, this->target_);
+  }
+
+ private:
+  Target_arm<big_endian>* target_;
+  const Section_list& sections_;
+};
 
 // Group input sections for stub generation.
 //
@@ -11493,17 +11925,70 @@ Target_arm<big_endian>::do_relax(
 	(*sp)->remove_all_cortex_a8_stubs();
     }
   
-  // Scan relocs for relocation stubs
+  std::vector<Arm_relobj<big_endian>*> arm_relobjs;
+  arm_relobjs.reserve(input_objects->number_of_relobjs());
   for (Input_objects::Relobj_iterator op = input_objects->relobj_begin();
        op != input_objects->relobj_end();
        ++op)
+    arm_relobjs.push_back(Arm_relobj<big_endian>::as_arm_relobj(*op));
+
+  // On the first pass, find the relocations which may need stubs.
+  // Later passes only look at those.
+  if (pass == 1)
     {
-      Arm_relobj<big_endian>* arm_relobj =
-	Arm_relobj<big_endian>::as_arm_relobj(*op);
-      // Lock the object so we can read from it.  This is only called
-      // single-threaded from Layout::finalize, so it is OK to lock.
-      Task_lock_obj<Object> tl(task, arm_relobj);
-      arm_relobj->scan_sections_for_stubs(this, symtab, layout);
+      for (size_t i = 0; i < arm_relobjs.size(); ++i)
+	{
+	  // Lock the object so we can read from it.  This is only called
+	  // single-threaded from Layout::finalize, so it is OK to lock.
+	  Task_lock_obj<Object> tl(task, arm_relobjs[i]);
+	  arm_relobjs[i]->find_branch_relocs(this, symtab, layout);
+	}
+    }
+
+  // Scan relocs for relocation stubs.  The objects are scanned in
+  // parallel, so the look-up maps of the output sections must be
+  // built first, and the merge maps of all the objects sorted, since
+  // a target may be in a merged section of any object.  The stubs are
+  // then added in object order.
+  for (Layout::Section_list::const_iterator p = layout->section_list().begin();
+       p != layout->section_list().end();
+       ++p)
+    (*p)->build_lookup_maps_if_needed();
+  for (size_t i = 0; i < arm_relobjs.size(); ++i)
+    if (arm_relobjs[i]->merge_map() != NULL)
+      arm_relobjs[i]->merge_map()->sort_mappings();
+
+  Stub_scanner scanner(this, arm_relobjs, symtab, layout);
+  Workqueue::run_in_parallel(&scanner, arm_relobjs.size());
+  for (size_t i = 0; i < arm_relobjs.size(); ++i)
+    this->add_requested_stubs(arm_relobjs[i]);
+
+  // Scan for the Cortex-A8 erratum after the relocation stubs are
+  // added, since that needs the branches recorded above.
+  // The sections are found and read with each object locked, then
+  // scanned in parallel, and the stubs are added in object order.
+  if (this->fix_cortex_a8_)
+    {
+      typename Cortex_a8_scanner::Section_list sections;
+      for (size_t i = 0; i < arm_relobjs.size(); ++i)
+	{
+	  Task_lock_obj<Object> tl(task, arm_relobjs[i]);
+	  arm_relobjs[i]->find_cortex_a8_sections(symtab);
+	  size_t count = arm_relobjs[i]->cortex_a8_section_count();
+	  for (size_t j = 0; j < count; ++j)
+	    sections.push_back(std::make_pair(arm_relobjs[i], j));
+	}
+
+      Cortex_a8_scanner scanner(this, sections);
+      Workqueue::run_in_parallel(&scanner, sections.size());
+
+      for (size_t i = 0; i < arm_relobjs.size(); ++i)
+	{
+	  if (arm_relobjs[i]->cortex_a8_section_count() == 0)
+	    continue;
+	  Task_lock_obj<Object> tl(task, arm_relobjs[i]);
+	  arm_relobjs[i]->add_cortex_a8_stubs();
+	}
     }
 
   // Check all stub tables to see if any of them have their data sizes
@@ -11669,7 +12154,9 @@ Target_arm<big_endian>::do_attributes_order(int num) const
   return num;
 }
 
-// Scan a span of THUMB code for Cortex-A8 erratum.
+// Scan a span of THUMB code for Cortex-A8 erratum.  The stubs needed
+// are added to STUBS in address order.  This only reads the target, so
+// it may be called for several spans in parallel.
 
 template<bool big_endian>
 void
@@ -11679,8 +12166,11 @@ Target_arm<big_endian>::scan_span_for_cortex_a8_erratum(
     section_size_type span_start,
     section_size_type span_end,
     const unsigned char* view,
-    Arm_address address)
+    Arm_address address,
+    std::vector<Cortex_a8_stub*>* stubs)
 {
+  typedef typename elfcpp::Swap<16, big_endian>::Valtype Valtype;
+
   // Scan for 32-bit Thumb-2 branches which span two 4K regions, where:
   //
   // The opcode is BLX.W, BL.W, B.W, Bcc.W
@@ -11688,12 +12178,42 @@ Target_arm<big_endian>::scan_span_for_cortex_a8_erratum(
   // first half of the branch.
   // The instruction before the branch is a 32-bit
   // length non-branch instruction.
+  //
+  // Such a branch can only start 2 bytes before a 4K boundary, so first
+  // look at just those offsets for a halfword pair with the encoding
+  // bits of a 32-bit branch.  This rarely matches, and then the span
+  // need not be decoded at all.  Otherwise the span must be decoded from
+  // its start, since only that tells where the instructions begin, but
+  // the decoding can stop after the last match.
+  // A branch whose second half is past the end of the span is always
+  // decoded, as the loop below does not stop at the end of the span.
+  section_size_type scan_end = 0;
+  for (section_size_type c = (span_start
+			      + ((0xffeU - (address + span_start)) & 0xfffU));
+       c + 2 <= span_end;
+       c += 0x1000)
+    {
+      const Valtype* wv = reinterpret_cast<const Valtype*>(view + c);
+      Valtype upper_insn = elfcpp::Swap<16, big_endian>::readval(wv);
+      if ((upper_insn & 0xf800U) != 0xf000U)
+	continue;
+      if (c + 4 > span_end)
+	scan_end = span_end;
+      else
+	{
+	  Valtype lower_insn = elfcpp::Swap<16, big_endian>::readval(wv + 1);
+	  if ((lower_insn & 0x8000U) != 0)
+	    scan_end = c + 4;
+	}
+    }
+  if (scan_end == 0)
+    return;
+
   section_size_type i = span_start;
   bool last_was_32bit = false;
   bool last_was_branch = false;
-  while (i < span_end)
+  while (i < scan_end)
     {
-      typedef typename elfcpp::Swap<16, big_endian>::Valtype Valtype;
       const Valtype* wv = reinterpret_cast<const Valtype*>(view + i);
       uint32_t insn = elfcpp::Swap<16, big_endian>::readval(wv);
       bool is_blx = false, is_b = false;
@@ -11825,10 +12345,7 @@ Target_arm<big_endian>::scan_span_for_cortex_a8_erratum(
 							    arm_relobj, shndx,
 							    address + i,
 							    target, insn);
-		  Stub_table<big_endian>* stub_table =
-		    arm_relobj->stub_table(shndx);
-		  gold_assert(stub_table != NULL);
-		  stub_table->add_cortex_a8_stub(address + i, stub);
+		  stubs->push_back(stub);
                 }
             }
         }
@@ -22,12 +22,15 @@
 
 #include "gold.h"
 
+#include <algorithm>
+
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 #endif
 
 #include "parameters.h"
 #include "options.h"
+#include "workqueue.h"
 #include "compressed_output.h"
 
 namespace gold
@@ -35,50 +38,133 @@ namespace gold
 
 #ifdef HAVE_ZLIB_H
 
+// The size of the pieces of a section which are compressed
+// separately.  Each piece is a complete zlib stream.  Readers of
+// compressed sections, including decompress_input_section below,
+// handle several streams concatenated together.  The size is fixed
+// so that the output does not depend on the number of threads.
+
+static const unsigned long zlib_chunk_size = 1024 * 1024;
+
+// A Parallel_runner used by zlib_compress.  Part I of this compresses
+// the Ith range of the chunks of the data, storing the result of
+// chunk J in (*CHUNKS)[J + 1].
+
+class Zlib_chunk_compressor : public Parallel_runner
+{
+ public:
+  Zlib_chunk_compressor(const unsigned char* uncompressed_data,
+			unsigned long uncompressed_size, int compress_level,
+			Output_compressed_section::Compressed_data* chunks,
+			unsigned int parts)
+    : uncompressed_data_(uncompressed_data),
+      uncompressed_size_(uncompressed_size),
+      compress_level_(compress_level), chunks_(chunks), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t count = this->chunks_->size() - 1;
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? count
+		  : count / this->parts_ * (part + 1));
+    for (size_t i = begin; i < end; ++i)
+      {
+	unsigned long start = i * zlib_chunk_size;
+	unsigned long len = std::min(zlib_chunk_size,
+				     this->uncompressed_size_ - start);
+	unsigned long size = compressBound(len);
+	unsigned char* data = new unsigned char[size];
+	int rc = compress2(reinterpret_cast<Bytef*>(data), &size,
+			   reinterpret_cast<const Bytef*>(this->uncompressed_data_
+							  + start),
+			   len, this->compress_level_);
+	if (rc != Z_OK)
+	  {
+	    delete[] data;
+	    data = NULL;
+	    size = 0;
+	  }
+	(*this->chunks_)[i + 1] = std::make_pair(data, size);
+      }
+  }
+
+ private:
+  const unsigned char* uncompressed_data_;
+  unsigned long uncompressed_size_;
+  int compress_level_;
+  Output_compressed_section::Compressed_data* chunks_;
+  unsigned int parts_;
+};
+
 // Compress UNCOMPRESSED_DATA of size UNCOMPRESSED_SIZE.  Returns true
 // if it successfully compressed, false if it failed for any reason
 // (including not having zlib support in the library).  If it returns
-// true, it allocates memory for the compressed data using new, and
-// sets *COMPRESSED_DATA and *COMPRESSED_SIZE to appropriate values.
-// It also writes a header before COMPRESSED_DATA: 4 bytes saying
-// "ZLIB", and 8 bytes indicating the uncompressed size, in big-endian
-// order.
+// true, it stores the compressed data in *CHUNKS, allocating the
+// memory using new, and sets *COMPRESSED_SIZE to the total size.
+// The first piece is a header: 4 bytes saying "ZLIB", and 8 bytes
+// indicating the uncompressed size, in big-endian order.  The data is
+// compressed in chunks using all the threads.
 
 static bool
 zlib_compress(const unsigned char* uncompressed_data,
               unsigned long uncompressed_size,
-              unsigned char** compressed_data,
+              Output_compressed_section::Compressed_data* chunks,
               unsigned long* compressed_size)
 {
   const int header_size = 12;
-  *compressed_size = uncompressed_size + uncompressed_size / 1000 + 128;
-  *compressed_data = new unsigned char[*compressed_size + header_size];
 
   int compress_level;
-  if (parameters->options().optimize() >= 1)
+  if (parameters->options().user_set_compress_debug_level())
+    compress_level = parameters->options().compress_debug_level();
+  else if (parameters->options().optimize() >= 1)
     compress_level = 9;
   else
     compress_level = 1;
 
-  int rc = compress2(reinterpret_cast<Bytef*>(*compressed_data) + header_size,
-                     compressed_size,
-                     reinterpret_cast<const Bytef*>(uncompressed_data),
-                     uncompressed_size,
-                     compress_level);
-  if (rc == Z_OK)
+  gold_assert(chunks->empty());
+  size_t count = ((uncompressed_size + zlib_chunk_size - 1)
+		  / zlib_chunk_size);
+  if (count == 0)
+    count = 1;
+  chunks->resize(count + 1);
+
+  unsigned int parts = std::max(1U,
+				std::min(Workqueue::parallel_thread_count(),
+					 static_cast<unsigned int>(count)));
+  Zlib_chunk_compressor compressor(uncompressed_data, uncompressed_size,
+				   compress_level, chunks, parts);
+  Workqueue::run_in_parallel(&compressor, parts);
+
+  unsigned char* header = new unsigned char[header_size];
+  memcpy(header, "ZLIB", 4);
+  elfcpp::Swap_unaligned<64, true>::writeval(header + 4, uncompressed_size);
+  (*chunks)[0] = std::make_pair(header, header_size);
+
+  bool success = true;
+  *compressed_size = 0;
+  for (Output_compressed_section::Compressed_data::const_iterator p =
+	 chunks->begin();
+       p != chunks->end();
+       ++p)
     {
-      memcpy(*compressed_data, "ZLIB", 4);
-      elfcpp::Swap_unaligned<64, true>::writeval(*compressed_data + 4,
-						 uncompressed_size);
-      *compressed_size += header_size;
-      return true;
+      if (p->first == NULL)
+	success = false;
+      *compressed_size += p->second;
     }
-  else
+
+  if (!success)
     {
-      delete[] *compressed_data;
-      *compressed_data = NULL;
-      return false;
+      for (Output_compressed_section::Compressed_data::const_iterator p =
+	     chunks->begin();
+	   p != chunks->end();
+	   ++p)
+	delete[] p->first;
+      chunks->clear();
     }
+  return success;
 }
 
 // Decompress COMPRESSED_DATA of size COMPRESSED_SIZE, into a buffer
@@ -128,7 +214,7 @@ zlib_decompress(const unsigned char* compressed_data,
 
 static bool
 zlib_compress(const unsigned char*, unsigned long,
-              unsigned char**, unsigned long*)
+              Output_compressed_section::Compressed_data*, unsigned long*)
 {
   return false;
 }
@@ -191,6 +277,14 @@ decompress_input_section(const unsigned char* compressed_data,
 
 // Class Output_compressed_section.
 
+Output_compressed_section::~Output_compressed_section()
+{
+  for (Compressed_data::const_iterator p = this->data_.begin();
+       p != this->data_.end();
+       ++p)
+    delete[] p->first;
+}
+
 // Set the final data size of a compressed section.  This is where
 // we actually compress the section data.
 
@@ -223,7 +317,7 @@ Output_compressed_section::set_final_data_size()
   else
     {
       gold_warning(_("not compressing section data: zlib error"));
-      gold_assert(this->data_ == NULL);
+      gold_assert(this->data_.empty());
       this->set_data_size(uncompressed_size);
     }
 }
@@ -237,10 +331,20 @@ Output_compressed_section::do_write(Output_file* of)
   off_t offset = this->offset();
   off_t data_size = this->data_size();
   unsigned char* view = of->get_output_view(offset, data_size);
-  if (this->data_ == NULL)
+  if (this->data_.empty())
     memcpy(view, this->postprocessing_buffer(), data_size);
   else
-    memcpy(view, this->data_, data_size);
+    {
+      unsigned char* pov = view;
+      for (Compressed_data::const_iterator p = this->data_.begin();
+	   p != this->data_.end();
+	   ++p)
+	{
+	  memcpy(pov, p->first, p->second);
+	  pov += p->second;
+	}
+      gold_assert(pov - view == data_size);
+    }
   of->write_output_view(offset, data_size, view);
 }
 
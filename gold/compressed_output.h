@@ -29,6 +29,7 @@
 #define GOLD_COMPRESSED_OUTPUT_H
 
 #include <string>
+#include <vector>
 
 #include "output.h"
 
@@ -56,13 +57,20 @@ decompress_input_section(const unsigned char*, unsigned long, unsigned char*,
 class Output_compressed_section : public Output_section
 {
  public:
+  // The compressed data is kept as a list of pieces, each allocated
+  // with new[], which are written out one after another.
+  typedef std::vector<std::pair<unsigned char*, unsigned long> >
+    Compressed_data;
+
   Output_compressed_section(const General_options* options,
 			    const char* name, elfcpp::Elf_Word flags,
 			    elfcpp::Elf_Xword type)
     : Output_section(name, flags, type),
-      options_(options)
+      options_(options), data_()
   { this->set_requires_postprocessing(); }
 
+  ~Output_compressed_section();
+
  protected:
   // Set the final data size.
   void
@@ -75,8 +83,8 @@ class Output_compressed_section : public Output_section
  private:
   // The options--this includes the compression type.
   const General_options* options_;
-  // The compressed data.
-  unsigned char* data_;
+  // The compressed data, empty if we did not compress.
+  Compressed_data data_;
   // The new section name if we do compress.
   std::string new_section_name_;
 };
@@ -22,48 +22,283 @@
 
 #include "gold.h"
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <ctime>
+#include <vector>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <dirent.h>
+#include <unistd.h>
 
 #include "debug.h"
 #include "gold-threads.h"
 #include "options.h"
+#include "parameters.h"
+#include "fileread.h"
 #include "workqueue.h"
 #include "dirsearch.h"
 
 namespace
 {
 
+// The names of the files in the library search directories, saved
+// by an earlier link in the file named by --dir-cache.  Each
+// directory is saved with its modification time, and is only used
+// if the directory has not been modified since.
+
+class Dir_cache_file
+{
+ public:
+  Dir_cache_file(const char* filename)
+    : filename_(filename), dirs_(), changed_(false)
+  { }
+
+  // Read the file.  A file which does not exist or can not be parsed
+  // is treated as empty.
+  void
+  read();
+
+  // If DIRNAME was saved with modification time MTIME, set *FILES to
+  // the names of its files and return true.
+  bool
+  lookup(const std::string& dirname, const gold::Timespec& mtime,
+	 std::vector<std::string>* files) const;
+
+  // Save the names of the files in DIRNAME, which has modification
+  // time MTIME.
+  void
+  save(const std::string& dirname, const gold::Timespec& mtime,
+       const std::vector<std::string>& files);
+
+  // Forget DIRNAME, whose contents can not be saved.
+  void
+  forget(const std::string& dirname);
+
+  // Write out the file if anything has changed.
+  void
+  write() const;
+
+ private:
+  // We can not copy this class.
+  Dir_cache_file(const Dir_cache_file&);
+  Dir_cache_file& operator=(const Dir_cache_file&);
+
+  // A saved directory.
+  struct Saved_dir
+  {
+    gold::Timespec mtime;
+    std::vector<std::string> files;
+  };
+
+  typedef Unordered_map<std::string, Saved_dir> Saved_dirs;
+
+  // The first line of the file.
+  static const char header[];
+
+  // The name of the file.
+  const char* filename_;
+  // The saved directories.
+  Saved_dirs dirs_;
+  // Whether any directory has changed since the file was read.
+  bool changed_;
+};
+
+const char Dir_cache_file::header[] = "gold dir cache 1\n";
+
+// The file starts with HEADER.  Each directory is a line holding the
+// seconds and nanoseconds of its modification time, the number of
+// files, and its name, followed by a line for each file.
+
+void
+Dir_cache_file::read()
+{
+  FILE* f = fopen(this->filename_, "r");
+  if (f == NULL)
+    return;
+  std::string contents;
+  char buf[8192];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof buf, f)) > 0)
+    contents.append(buf, len);
+  fclose(f);
+
+  const char* p = contents.c_str();
+  const char* const pend = p + contents.length();
+  if (contents.compare(0, sizeof header - 1, header) != 0)
+    return;
+  p += sizeof header - 1;
+
+  Saved_dirs dirs;
+  while (p < pend)
+    {
+      char* q;
+      gold::Timespec mtime;
+      mtime.seconds = strtoll(p, &q, 10);
+      mtime.nanoseconds = strtol(q, &q, 10);
+      unsigned long count = strtoul(q, &q, 10);
+      const char* eol = static_cast<const char*>(memchr(q, '\n', pend - q));
+      if (*q != ' ' || eol == NULL)
+	return;
+      Saved_dir& saved(dirs[std::string(q + 1, eol - q - 1)]);
+      saved.mtime = mtime;
+      p = eol + 1;
+      for (unsigned long i = 0; i < count; ++i)
+	{
+	  eol = static_cast<const char*>(memchr(p, '\n', pend - p));
+	  if (eol == NULL)
+	    return;
+	  saved.files.push_back(std::string(p, eol));
+	  p = eol + 1;
+	}
+    }
+  this->dirs_.swap(dirs);
+}
+
+bool
+Dir_cache_file::lookup(const std::string& dirname,
+		       const gold::Timespec& mtime,
+		       std::vector<std::string>* files) const
+{
+  Saved_dirs::const_iterator p = this->dirs_.find(dirname);
+  if (p == this->dirs_.end()
+      || p->second.mtime.seconds != mtime.seconds
+      || p->second.mtime.nanoseconds != mtime.nanoseconds)
+    return false;
+  *files = p->second.files;
+  return true;
+}
+
+void
+Dir_cache_file::save(const std::string& dirname,
+		     const gold::Timespec& mtime,
+		     const std::vector<std::string>& files)
+{
+  Saved_dir& saved(this->dirs_[dirname]);
+  saved.mtime = mtime;
+  saved.files = files;
+  this->changed_ = true;
+}
+
+void
+Dir_cache_file::forget(const std::string& dirname)
+{
+  if (this->dirs_.erase(dirname) > 0)
+    this->changed_ = true;
+}
+
+// Write the file under a temporary name and rename it, so that a
+// link running at the same time never sees a partial file.
+
+void
+Dir_cache_file::write() const
+{
+  if (!this->changed_)
+    return;
+
+  char pid[32];
+  snprintf(pid, sizeof pid, ".%ld", static_cast<long>(getpid()));
+  std::string tmpname = std::string(this->filename_) + pid;
+  FILE* f = fopen(tmpname.c_str(), "w");
+  if (f == NULL)
+    {
+      gold::gold_warning(_("%s: can not write directory cache: %s"),
+			 tmpname.c_str(), strerror(errno));
+      return;
+    }
+
+  fputs(header, f);
+  for (Saved_dirs::const_iterator p = this->dirs_.begin();
+       p != this->dirs_.end();
+       ++p)
+    {
+      const Saved_dir& saved(p->second);
+      fprintf(f, "%lld %d %lu %s\n",
+	      static_cast<long long>(saved.mtime.seconds),
+	      saved.mtime.nanoseconds,
+	      static_cast<unsigned long>(saved.files.size()),
+	      p->first.c_str());
+      for (std::vector<std::string>::const_iterator q = saved.files.begin();
+	   q != saved.files.end();
+	   ++q)
+	fprintf(f, "%s\n", q->c_str());
+    }
+
+  if (fclose(f) != 0)
+    {
+      gold::gold_warning(_("%s: can not write directory cache: %s"),
+			 tmpname.c_str(), strerror(errno));
+      unlink(tmpname.c_str());
+      return;
+    }
+  if (rename(tmpname.c_str(), this->filename_) != 0)
+    {
+      gold::gold_warning(_("%s: can not rename directory cache: %s"),
+			 this->filename_, strerror(errno));
+      unlink(tmpname.c_str());
+    }
+}
+
 // Read all the files in a directory.
 
 class Dir_cache
 {
  public:
   Dir_cache(const char* dirname)
-    : dirname_(dirname), files_()
+    : dirname_(dirname), files_(), mtime_(), have_mtime_(false),
+      from_cache_file_(false)
   { }
 
-  // Read the files in the directory.
-  void read_files();
+  // Read the files in the directory, or get them from CACHE_FILE if
+  // it is not NULL and the directory has not changed.
+  void
+  read_files(const Dir_cache_file* cache_file);
+
+  // Return the names of the files in the directory.
+  const std::vector<std::string>&
+  files() const
+  { return this->files_; }
 
-  // Return whether a file (a base name) is present in the directory.
-  bool find(const std::string&) const;
+  // Update CACHE_FILE with the files in this directory.
+  void
+  update_cache_file(Dir_cache_file* cache_file) const;
 
  private:
   // We can not copy this class.
   Dir_cache(const Dir_cache&);
   Dir_cache& operator=(const Dir_cache&);
 
+  // Return whether the names of the files may be saved.
+  bool
+  can_save() const;
+
   const char* dirname_;
-  Unordered_set<std::string> files_;
+  // The names of the files.
+  std::vector<std::string> files_;
+  // The modification time of the directory, if HAVE_MTIME_.
+  gold::Timespec mtime_;
+  bool have_mtime_;
+  // Whether the names came from the cache file.
+  bool from_cache_file_;
 };
 
 void
-Dir_cache::read_files()
+Dir_cache::read_files(const Dir_cache_file* cache_file)
 {
+  if (cache_file != NULL)
+    {
+      this->have_mtime_ = gold::get_mtime(this->dirname_, &this->mtime_);
+      if (this->have_mtime_
+	  && cache_file->lookup(this->dirname_, this->mtime_, &this->files_))
+	{
+	  this->from_cache_file_ = true;
+	  return;
+	}
+    }
+
   DIR* d = opendir(this->dirname_);
   if (d == NULL)
     {
@@ -76,88 +311,163 @@ Dir_cache::read_files()
 
   dirent* de;
   while ((de = readdir(d)) != NULL)
-    this->files_.insert(std::string(de->d_name));
+    this->files_.push_back(std::string(de->d_name));
 
   if (closedir(d) != 0)
     gold::gold_warning("%s: closedir failed: %s", this->dirname_,
 		       strerror(errno));
 }
 
+// We don't save a directory which was modified within the last
+// second or so, since it could be modified again without changing
+// its modification time.  We don't save a relative directory, which
+// means something else to a link run elsewhere, or a file name which
+// the cache file can not represent.
+
 bool
-Dir_cache::find(const std::string& basename) const
+Dir_cache::can_save() const
+{
+  if (this->dirname_[0] != '/')
+    return false;
+  if (!this->have_mtime_ || this->mtime_.seconds + 2 > time(NULL))
+    return false;
+  for (std::vector<std::string>::const_iterator p = this->files_.begin();
+       p != this->files_.end();
+       ++p)
+    if (p->find('\n') != std::string::npos)
+      return false;
+  return true;
+}
+
+void
+Dir_cache::update_cache_file(Dir_cache_file* cache_file) const
 {
-  return this->files_.find(basename) != this->files_.end();
+  if (this->from_cache_file_)
+    return;
+  if (this->can_save())
+    cache_file->save(this->dirname_, this->mtime_, this->files_);
+  else
+    cache_file->forget(this->dirname_);
 }
 
-// A mapping from directory names to caches.  A lock permits
-// concurrent update.  There is no lock for read operations--some
-// other mechanism must be used to prevent reads from conflicting with
-// writes.
+// The contents of all the search directories, and an index from a
+// file name to the directories which hold it.  The directories are
+// read by separate tasks.  When the last one is done, it builds the
+// index.  After that the index may be read without locking.
 
 class Dir_caches
 {
  public:
-  Dir_caches()
-    : lock_(), caches_()
-  { }
+  Dir_caches(const gold::General_options::Dir_list* directories,
+	     const char* cache_filename);
 
-  ~Dir_caches();
+  // Read directory INDEX.  Return true if all the directories have
+  // now been read.
+  bool
+  read(unsigned int index);
 
-  // Add a cache for a directory.
-  void add(const char*);
+  // Build the index, and update the cache file.  This is called after
+  // all the directories have been read.
+  void
+  finish();
 
-  // Look up a directory in the cache.  This much be locked against
-  // calls to Add.
-  Dir_cache* lookup(const char*) const;
+  // Return the indexes of the directories which hold the file NAME,
+  // in increasing order, or NULL if none do.
+  const std::vector<unsigned int>*
+  lookup(const std::string& name) const;
 
  private:
   // We can not copy this class.
   Dir_caches(const Dir_caches&);
   Dir_caches& operator=(const Dir_caches&);
 
-  typedef Unordered_map<const char*, Dir_cache*> Cache_hash;
+  typedef Unordered_map<std::string, std::vector<unsigned int> > Name_index;
 
   gold::Lock lock_;
-  Cache_hash caches_;
+  // The directories, indexed like the search path.
+  std::vector<Dir_cache*> caches_;
+  // The number of directories which have not been read.
+  unsigned int unread_;
+  // The cache file from --dir-cache, or NULL.
+  Dir_cache_file* cache_file_;
+  // The directories holding each file name.
+  Name_index index_;
 };
 
-Dir_caches::~Dir_caches()
+Dir_caches::Dir_caches(const gold::General_options::Dir_list* directories,
+		       const char* cache_filename)
+  : lock_(), caches_(), unread_(directories->size()), cache_file_(NULL),
+    index_()
 {
-  for (Cache_hash::iterator p = this->caches_.begin();
-       p != this->caches_.end();
+  this->caches_.reserve(directories->size());
+  for (gold::General_options::Dir_list::const_iterator p =
+	 directories->begin();
+       p != directories->end();
        ++p)
-    delete p->second;
+    this->caches_.push_back(new Dir_cache(p->name().c_str()));
+
+  if (cache_filename != NULL)
+    {
+      this->cache_file_ = new Dir_cache_file(cache_filename);
+      this->cache_file_->read();
+    }
 }
 
-void
-Dir_caches::add(const char* dirname)
+bool
+Dir_caches::read(unsigned int index)
 {
-  {
-    gold::Hold_lock hl(this->lock_);
-    if (this->lookup(dirname) != NULL)
-      return;
-  }
+  this->caches_[index]->read_files(this->cache_file_);
 
-  Dir_cache* cache = new Dir_cache(dirname);
+  gold::Hold_lock hl(this->lock_);
+  gold_assert(this->unread_ > 0);
+  --this->unread_;
+  return this->unread_ == 0;
+}
 
-  cache->read_files();
+void
+Dir_caches::finish()
+{
+  for (unsigned int i = 0; i < this->caches_.size(); ++i)
+    {
+      const std::vector<std::string>& files(this->caches_[i]->files());
+      for (std::vector<std::string>::const_iterator p = files.begin();
+	   p != files.end();
+	   ++p)
+	{
+	  std::vector<unsigned int>& dirs(this->index_[*p]);
+	  // A directory may list a name twice if it changes while we
+	  // read it.
+	  if (dirs.empty() || dirs.back() != i)
+	    dirs.push_back(i);
+	}
+    }
 
-  {
-    gold::Hold_lock hl(this->lock_);
+  if (this->cache_file_ != NULL)
+    {
+      for (std::vector<Dir_cache*>::const_iterator p = this->caches_.begin();
+	   p != this->caches_.end();
+	   ++p)
+	(*p)->update_cache_file(this->cache_file_);
+      this->cache_file_->write();
+      delete this->cache_file_;
+      this->cache_file_ = NULL;
+    }
 
-    std::pair<const char*, Dir_cache*> v(dirname, cache);
-    std::pair<Cache_hash::iterator, bool> p = this->caches_.insert(v);
-    gold_assert(p.second);
-  }
+  // The index holds all the names now.
+  for (std::vector<Dir_cache*>::iterator p = this->caches_.begin();
+       p != this->caches_.end();
+       ++p)
+    delete *p;
+  this->caches_.clear();
 }
 
-Dir_cache*
-Dir_caches::lookup(const char* dirname) const
+const std::vector<unsigned int>*
+Dir_caches::lookup(const std::string& name) const
 {
-  Cache_hash::const_iterator p = this->caches_.find(dirname);
-  if (p == this->caches_.end())
+  Name_index::const_iterator p = this->index_.find(name);
+  if (p == this->index_.end())
     return NULL;
-  return p->second;
+  return &p->second;
 }
 
 // The caches.
@@ -169,8 +479,9 @@ Dir_caches* caches;
 class Dir_cache_task : public gold::Task
 {
  public:
-  Dir_cache_task(const char* dir, gold::Task_token& token)
-    : dir_(dir), token_(token)
+  Dir_cache_task(const char* dir, unsigned int index,
+		 gold::Task_token& token)
+    : dir_(dir), index_(index), token_(token)
   { }
 
   gold::Task_token*
@@ -188,6 +499,7 @@ class Dir_cache_task : public gold::Task
 
  private:
   const char* dir_;
+  unsigned int index_;
   gold::Task_token& token_;
 };
 
@@ -208,12 +520,26 @@ Dir_cache_task::locks(gold::Task_locker* tl)
   tl->add(this, &this->token_);
 }
 
-// Run the task--read the directory contents.
+// Run the task--read the directory contents.  The last task to
+// finish builds the index, before the blocker is released.
 
 void
 Dir_cache_task::run(gold::Workqueue*)
 {
-  caches->add(this->dir_);
+  if (caches->read(this->index_))
+    caches->finish();
+}
+
+// Return the first entry in DIRS which is at least START, or -1U.
+
+unsigned int
+first_dir_from(const std::vector<unsigned int>* dirs, unsigned int start)
+{
+  if (dirs == NULL)
+    return -1U;
+  std::vector<unsigned int>::const_iterator p =
+    std::lower_bound(dirs->begin(), dirs->end(), start);
+  return p == dirs->end() ? -1U : *p;
 }
 
 }
@@ -228,13 +554,14 @@ Dirsearch::initialize(Workqueue* workqueue,
 		      const General_options::Dir_list* directories)
 {
   gold_assert(caches == NULL);
-  caches = new Dir_caches;
+  caches = new Dir_caches(directories, parameters->options().dir_cache());
   this->directories_ = directories;
   this->token_.add_blockers(directories->size());
+  unsigned int i = 0;
   for (General_options::Dir_list::const_iterator p = directories->begin();
        p != directories->end();
-       ++p)
-    workqueue->queue(new Dir_cache_task(p->name().c_str(), this->token_));
+       ++p, ++i)
+    workqueue->queue(new Dir_cache_task(p->name().c_str(), i, this->token_));
 }
 
 // Search for a file.  NOTE: we only log failed file-lookup attempts
@@ -248,39 +575,40 @@ Dirsearch::find(const std::string& n1, const std::string& n2,
   gold_assert(!this->token_.is_blocked());
   gold_assert(*pindex >= 0);
 
-  for (unsigned int i = static_cast<unsigned int>(*pindex);
-       i < this->directories_->size();
-       ++i)
+  unsigned int start = static_cast<unsigned int>(*pindex);
+  unsigned int i1 = first_dir_from(caches->lookup(n1), start);
+  unsigned int i2 = (n2.empty()
+		     ? -1U
+		     : first_dir_from(caches->lookup(n2), start));
+  unsigned int found = std::min(i1, i2);
+
+  if (is_debugging_enabled(DEBUG_FILES))
     {
-      const Search_directory* p = &this->directories_->at(i);
-      Dir_cache* pdc = caches->lookup(p->name().c_str());
-      gold_assert(pdc != NULL);
-      if (pdc->find(n1))
+      unsigned int end = (found == -1U
+			  ? this->directories_->size()
+			  : found + 1);
+      for (unsigned int i = start; i < end; ++i)
 	{
-	  *is_in_sysroot = p->is_in_sysroot();
-	  *pindex = i;
-	  return p->name() + '/' + n1;
-	}
-      else
-        gold_debug(DEBUG_FILES, "Attempt to open %s/%s failed",
-                   p->name().c_str(), n1.c_str());
-
-      if (!n2.empty())
-        {
-          if (pdc->find(n2))
-            {
-              *is_in_sysroot = p->is_in_sysroot();
-	      *pindex = i;
-              return p->name() + '/' + n2;
-            }
-          else
-            gold_debug(DEBUG_FILES, "Attempt to open %s/%s failed",
-                       p->name().c_str(), n2.c_str());
+	  const char* dirname = this->directories_->at(i).name().c_str();
+	  if (i != i1)
+	    gold_debug(DEBUG_FILES, "Attempt to open %s/%s failed",
+		       dirname, n1.c_str());
+	  if (i != found && !n2.empty())
+	    gold_debug(DEBUG_FILES, "Attempt to open %s/%s failed",
+		       dirname, n2.c_str());
 	}
     }
 
-  *pindex = -2;
-  return std::string();
+  if (found == -1U)
+    {
+      *pindex = -2;
+      return std::string();
+    }
+
+  const Search_directory* p = &this->directories_->at(found);
+  *is_in_sysroot = p->is_in_sysroot();
+  *pindex = found;
+  return p->name() + '/' + (found == i1 ? n1 : n2);
 }
 
 // Search for a file in a directory list.  This is a low-level function and
@@ -64,8 +64,67 @@ ResetLineStateMachine(struct LineStateMachine* lsm, bool default_is_stmt)
 template<int size, bool big_endian>
 Sized_dwarf_line_info<size, big_endian>::Sized_dwarf_line_info(Object* object,
                                                                unsigned int read_shndx)
-  : data_valid_(false), buffer_(NULL), symtab_buffer_(NULL),
+  : data_valid_(false), buffer_(NULL), buffer_start_(NULL),
+    owned_buffer_(NULL), read_shndxs_(), symtab_buffer_(NULL),
     directories_(), files_(), current_header_index_(-1)
+{
+  if (read_shndx != -1U)
+    this->read_shndxs_.push_back(read_shndx);
+  if (!this->read_sections(object))
+    return;
+
+  // Now that we have successfully read all the data, parse the debug
+  // info.
+  this->data_valid_ = true;
+  this->read_relocs(object);
+  this->read_line_mappings();
+}
+
+template<int size, bool big_endian>
+Sized_dwarf_line_info<size, big_endian>::Sized_dwarf_line_info(
+    Object* object,
+    const std::vector<unsigned int>& read_shndxs)
+  : data_valid_(false), buffer_(NULL), buffer_start_(NULL),
+    owned_buffer_(NULL), read_shndxs_(read_shndxs), symtab_buffer_(NULL),
+    directories_(), files_(), current_header_index_(-1)
+{
+  if (!this->read_sections(object))
+    return;
+  this->data_valid_ = true;
+  this->read_relocs(object);
+
+  // The views of OBJECT go away when it is unlocked, so keep our own
+  // copy of the line information to decode later.  After this we
+  // only check symtab_buffer_ against NULL.
+  if (this->owned_buffer_ == NULL)
+    {
+      section_size_type len = this->buffer_end_ - this->buffer_;
+      this->owned_buffer_ = new unsigned char[len];
+      memcpy(this->owned_buffer_, this->buffer_, len);
+      this->buffer_ = this->owned_buffer_;
+      this->buffer_start_ = this->owned_buffer_;
+      this->buffer_end_ = this->owned_buffer_ + len;
+    }
+}
+
+// Decode the line information which the second constructor read.  We
+// don't need the line information itself after this.
+
+template<int size, bool big_endian>
+void
+Sized_dwarf_line_info<size, big_endian>::do_decode()
+{
+  if (this->data_valid_)
+    this->read_line_mappings();
+  delete[] this->owned_buffer_;
+  this->owned_buffer_ = NULL;
+  this->buffer_ = this->buffer_start_ = this->buffer_end_ = NULL;
+  this->reloc_map_.clear();
+}
+
+template<int size, bool big_endian>
+bool
+Sized_dwarf_line_info<size, big_endian>::read_sections(Object* object)
 {
   unsigned int debug_shndx;
   for (debug_shndx = 1; debug_shndx < object->shnum(); ++debug_shndx)
@@ -82,7 +141,7 @@ Sized_dwarf_line_info<size, big_endian>::Sized_dwarf_line_info(Object* object,
 	}
     }
   if (this->buffer_ == NULL)
-    return;
+    return false;
 
   section_size_type uncompressed_size = 0;
   unsigned char* uncompressed_data = NULL;
@@ -97,7 +156,9 @@ Sized_dwarf_line_info<size, big_endian>::Sized_dwarf_line_info(Object* object,
 		      object->section_name(debug_shndx).c_str());
       this->buffer_ = uncompressed_data;
       this->buffer_end_ = this->buffer_ + uncompressed_size;
+      this->owned_buffer_ = uncompressed_data;
     }
+  this->buffer_start_ = this->buffer_;
 
   // Find the relocation section for ".debug_line".
   // We expect these for relobjs (.o's) but not dynobjs (.so's).
@@ -130,13 +191,10 @@ Sized_dwarf_line_info<size, big_endian>::Sized_dwarf_line_info(Object* object,
             break;
           }
       if (this->symtab_buffer_ == NULL)
-        return;
+        return false;
     }
 
-  // Now that we have successfully read all the data, parse the debug
-  // info.
-  this->data_valid_ = true;
-  this->read_line_mappings(object, read_shndx);
+  return true;
 }
 
 // Read the DWARF header.
@@ -396,7 +454,7 @@ Sized_dwarf_line_info<size, big_endian>::process_one_opcode(
               lsm->address =
 		elfcpp::Swap_unaligned<size, big_endian>::readval(start);
               typename Reloc_map::const_iterator it
-                  = this->reloc_map_.find(start - this->buffer_);
+                  = this->reloc_map_.find(start - this->buffer_start_);
               if (it != reloc_map_.end())
                 {
 		  // If this is a SHT_RELA section, then ignore the
@@ -468,8 +526,7 @@ Sized_dwarf_line_info<size, big_endian>::process_one_opcode(
 
 template<int size, bool big_endian>
 unsigned const char*
-Sized_dwarf_line_info<size, big_endian>::read_lines(unsigned const char* lineptr,
-                                                    unsigned int shndx)
+Sized_dwarf_line_info<size, big_endian>::read_lines(unsigned const char* lineptr)
 {
   struct LineStateMachine lsm;
 
@@ -491,8 +548,7 @@ Sized_dwarf_line_info<size, big_endian>::read_lines(unsigned const char* lineptr
         {
           size_t oplength;
           bool add_line = this->process_one_opcode(lineptr, &lsm, &oplength);
-          if (add_line
-              && (shndx == -1U || lsm.shndx == -1U || shndx == lsm.shndx))
+          if (add_line && this->want_section(lsm.shndx))
             {
               Offset_to_lineno_entry entry
                   = { lsm.address, this->current_header_index_,
@@ -564,23 +620,49 @@ Sized_dwarf_line_info<size, big_endian>::read_relocs(Object* object)
     }
 }
 
+// In a relocatable object, the relocations for the DW_LNE_set_address
+// opcodes of a line number program tell us which sections it
+// describes, without decoding it.
+
+template<int size, bool big_endian>
+bool
+Sized_dwarf_line_info<size, big_endian>::unit_is_wanted(off_t start,
+							off_t end) const
+{
+  if (this->read_shndxs_.empty() || !this->input_is_relobj())
+    return true;
+  for (typename Reloc_map::const_iterator p =
+	 this->reloc_map_.lower_bound(start);
+       p != this->reloc_map_.end() && static_cast<off_t>(p->first) < end;
+       ++p)
+    if (this->want_section(p->second.first))
+      return true;
+  return false;
+}
+
 // Read the line number info.
 
 template<int size, bool big_endian>
 void
-Sized_dwarf_line_info<size, big_endian>::read_line_mappings(Object* object,
-							    unsigned int shndx)
+Sized_dwarf_line_info<size, big_endian>::read_line_mappings()
 {
   gold_assert(this->data_valid_ == true);
 
-  this->read_relocs(object);
   while (this->buffer_ < this->buffer_end_)
     {
       const unsigned char* lineptr = this->buffer_;
       lineptr = this->read_header_prolog(lineptr);
-      lineptr = this->read_header_tables(lineptr);
-      lineptr = this->read_lines(lineptr, shndx);
-      this->buffer_ = lineptr;
+      const unsigned char* unit_end = (this->buffer_
+				       + (header_.offset_size == 8 ? 12 : 4)
+				       + header_.total_length);
+      // Skip the line number programs for sections we don't want.
+      if (this->unit_is_wanted(this->buffer_ - this->buffer_start_,
+			       unit_end - this->buffer_start_))
+	{
+	  lineptr = this->read_header_tables(lineptr);
+	  lineptr = this->read_lines(lineptr);
+	}
+      this->buffer_ = unit_end;
     }
 
   // Sort the lines numbers, so addr2line can use binary search.
@@ -599,7 +681,7 @@ Sized_dwarf_line_info<size, big_endian>::read_line_mappings(Object* object,
 
 template<int size, bool big_endian>
 bool
-Sized_dwarf_line_info<size, big_endian>::input_is_relobj()
+Sized_dwarf_line_info<size, big_endian>::input_is_relobj() const
 {
   // Only .o files have relocs and the symtab buffer that goes with them.
   return this->symtab_buffer_ != NULL;
@@ -914,6 +996,33 @@ Dwarf_line_info::one_addr2line(Object* object,
   return retval;
 }
 
+Dwarf_line_info*
+Dwarf_line_info::create_deferred(Object* object,
+				 const std::vector<unsigned int>& shndxs)
+{
+  switch (parameters->size_and_endianness())
+    {
+#ifdef HAVE_TARGET_32_LITTLE
+    case Parameters::TARGET_32_LITTLE:
+      return new Sized_dwarf_line_info<32, false>(object, shndxs);
+#endif
+#ifdef HAVE_TARGET_32_BIG
+    case Parameters::TARGET_32_BIG:
+      return new Sized_dwarf_line_info<32, true>(object, shndxs);
+#endif
+#ifdef HAVE_TARGET_64_LITTLE
+    case Parameters::TARGET_64_LITTLE:
+      return new Sized_dwarf_line_info<64, false>(object, shndxs);
+#endif
+#ifdef HAVE_TARGET_64_BIG
+    case Parameters::TARGET_64_BIG:
+      return new Sized_dwarf_line_info<64, true>(object, shndxs);
+#endif
+    default:
+      gold_unreachable();
+    }
+}
+
 void
 Dwarf_line_info::clear_addr2line_cache()
 {
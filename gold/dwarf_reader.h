@@ -23,6 +23,7 @@
 #ifndef GOLD_DWARF_READER_H
 #define GOLD_DWARF_READER_H
 
+#include <algorithm>
 #include <vector>
 #include <map>
 #include <limits.h>
@@ -90,6 +91,20 @@ class Dwarf_line_info
             std::vector<std::string>* other_lines)
   { return this->do_addr2line(shndx, offset, other_lines); }
 
+  // Decode the line information of a reader made by create_deferred.
+  // This does not use the object, so it need not be locked, and
+  // several readers may decode at once on different threads.
+  void
+  decode()
+  { this->do_decode(); }
+
+  // Create a reader for OBJECT which only keeps the line information
+  // for the sections in SHNDXS, which must be sorted.  This copies
+  // what it needs from OBJECT, which must be locked, but does not
+  // decode anything until decode is called.
+  static Dwarf_line_info*
+  create_deferred(Object* object, const std::vector<unsigned int>& shndxs);
+
   // A helper function for a single addr2line lookup.  It also keeps a
   // cache of the last CACHE_SIZE Dwarf_line_info objects it created;
   // set to 0 not to cache at all.  The larger CACHE_SIZE is, the more
@@ -109,6 +124,9 @@ class Dwarf_line_info
   virtual std::string
   do_addr2line(unsigned int shndx, off_t offset,
                std::vector<std::string>* other_lines) = 0;
+
+  virtual void
+  do_decode() = 0;
 };
 
 template<int size, bool big_endian>
@@ -120,20 +138,54 @@ class Sized_dwarf_line_info : public Dwarf_line_info
   // information that pertains to the specified section.
   Sized_dwarf_line_info(Object* object, unsigned int read_shndx = -1U);
 
+  // Initializes a .debug_line reader which only reads the debug
+  // information for the sections in READ_SHNDXS, a sorted list.  The
+  // line number programs are not decoded until decode is called.
+  Sized_dwarf_line_info(Object* object,
+			const std::vector<unsigned int>& read_shndxs);
+
+  ~Sized_dwarf_line_info()
+  { delete[] this->owned_buffer_; }
+
  private:
   std::string
   do_addr2line(unsigned int shndx, off_t offset,
                std::vector<std::string>* other_lines);
 
+  void
+  do_decode();
+
+  // Find the .debug_line section and the relocations for it.  Return
+  // false if there is no usable line information.
+  bool
+  read_sections(Object*);
+
   // Formats a file and line number to a string like "dirname/filename:lineno".
   std::string
   format_file_lineno(const Offset_to_lineno_entry& lineno) const;
 
   // Start processing line info, and populates the offset_map_.
-  // If SHNDX is non-negative, only store debug information that
-  // pertains to the specified section.
+  // Only store debug information that pertains to the sections in
+  // read_shndxs_.
   void
-  read_line_mappings(Object*, unsigned int shndx);
+  read_line_mappings();
+
+  // Return whether we should store line information for section
+  // SHNDX.
+  bool
+  want_section(unsigned int shndx) const
+  {
+    return (this->read_shndxs_.empty()
+	    || shndx == -1U
+	    || std::binary_search(this->read_shndxs_.begin(),
+				  this->read_shndxs_.end(), shndx));
+  }
+
+  // Return whether the line number program from offset START to
+  // offset END in .debug_line may have information for a section we
+  // want.
+  bool
+  unit_is_wanted(off_t start, off_t end) const;
 
   // Reads the relocation section associated with .debug_line and
   // stores relocation information in reloc_map_.
@@ -154,11 +206,10 @@ class Sized_dwarf_line_info : public Dwarf_line_info
   const unsigned char*
   read_header_tables(const unsigned char* lineptr);
 
-  // Reads the DWARF2/3 line information.  If shndx is non-negative,
-  // discard all line information that doesn't pertain to the given
-  // section.
+  // Reads the DWARF2/3 line information.  Discard all line
+  // information that doesn't pertain to a section we want.
   const unsigned char*
-  read_lines(const unsigned char* lineptr, unsigned int shndx);
+  read_lines(const unsigned char* lineptr);
 
   // Process a single line info opcode at START using the state
   // machine at LSM.  Return true if we should define a line using the
@@ -170,7 +221,7 @@ class Sized_dwarf_line_info : public Dwarf_line_info
 
   // Some parts of processing differ depending on whether the input
   // was a .o file or not.
-  bool input_is_relobj();
+  bool input_is_relobj() const;
 
   // If we saw anything amiss while parsing, we set this to false.
   // Then addr2line will always fail (rather than return possibly-
@@ -199,6 +250,15 @@ class Sized_dwarf_line_info : public Dwarf_line_info
   // the line info to read is.
   const unsigned char* buffer_;
   const unsigned char* buffer_end_;
+  // The start of the .debug_line section, which relocation offsets
+  // are relative to.
+  const unsigned char* buffer_start_;
+  // The buffer, if we allocated it.
+  unsigned char* owned_buffer_;
+
+  // The sections whose line information we keep, sorted.  If this is
+  // empty, we keep all of it.
+  std::vector<unsigned int> read_shndxs_;
 
   // This has relocations that point into buffer.
   Track_relocs<size, big_endian> track_relocs_;
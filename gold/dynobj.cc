@@ -29,6 +29,7 @@
 #include "parameters.h"
 #include "script.h"
 #include "symtab.h"
+#include "workqueue.h"
 #include "dynobj.h"
 
 namespace gold
@@ -42,7 +43,7 @@ namespace gold
 Dynobj::Dynobj(const std::string& name, Input_file* input_file, off_t offset)
   : Object(name, input_file, true, offset),
     needed_(),
-    unknown_needed_(UNKNOWN_NEEDED_UNSET)
+    unknown_needed_(UNKNOWN_NEEDED_UNSET), defines_relr_version_(false)
 {
   // This will be overridden by a DT_SONAME entry, hopefully.  But if
   // we never see a DT_SONAME entry, our rule is to use the dynamic
@@ -513,7 +514,7 @@ template<int size, bool big_endian>
 void
 Sized_dynobj<size, big_endian>::make_verdef_map(
     Read_symbols_data* sd,
-    Version_map* version_map) const
+    Version_map* version_map)
 {
   if (sd->verdef == NULL)
     return;
@@ -573,6 +574,8 @@ Sized_dynobj<size, big_endian>::make_verdef_map(
 	}
 
       this->set_version_map(version_map, vd_ndx, names + vda_name);
+      if (strcmp(names + vda_name, "GLIBC_ABI_DT_RELR") == 0)
+	this->set_defines_relr_version();
 
       const section_size_type vd_next = verdef.get_vd_next();
       if ((p - pverdef) + vd_next >= verdef_size)
@@ -671,7 +674,7 @@ template<int size, bool big_endian>
 void
 Sized_dynobj<size, big_endian>::make_version_map(
     Read_symbols_data* sd,
-    Version_map* version_map) const
+    Version_map* version_map)
 {
   if (sd->verdef == NULL && sd->verneed == NULL)
     return;
@@ -840,9 +843,8 @@ Dynobj::compute_bucket_count(const std::vector<uint32_t>& hashcodes,
   // Array used to determine the number of hash table buckets to use
   // based on the number of symbols there are.  If there are fewer
   // than 3 symbols we use 1 bucket, fewer than 17 symbols we use 3
-  // buckets, fewer than 37 we use 17 buckets, and so forth.  We never
-  // use more than 262147 buckets.  This is straight from the old GNU
-  // linker.
+  // buckets, fewer than 37 we use 17 buckets, and so forth.  This is
+  // straight from the old GNU linker.
   static const unsigned int buckets[] =
   {
     1, 3, 17, 37, 67, 97, 131, 197, 263, 521, 1031, 2053, 4099, 8209,
@@ -861,12 +863,84 @@ Dynobj::compute_bucket_count(const std::vector<uint32_t>& hashcodes,
       ret = buckets[i];
     }
 
+  // When there are more symbols than the largest table entry, rather
+  // than letting the chains grow without bound, use the largest prime
+  // which is no more than the number of symbols.  We don't honor
+  // --hash-bucket-empty-fraction here, which could ask for many times
+  // more buckets than symbols.
+  if (symcount > buckets[buckets_count - 1])
+    {
+      unsigned int n = (symcount - 1) | 1;
+      while (n > ret && !Dynobj::is_prime(n))
+	n -= 2;
+      if (n > ret)
+	ret = n;
+    }
+
   if (for_gnu_hash_table && ret < 2)
     ret = 2;
 
   return ret;
 }
 
+// Return whether N, which is odd, is prime.
+
+bool
+Dynobj::is_prime(unsigned int n)
+{
+  for (unsigned int d = 3; d <= n / d; d += 2)
+    if (n % d == 0)
+      return false;
+  return n > 1;
+}
+
+// Class Dynobj::Symbol_hasher.  Part I of this computes the hash codes
+// of the Ith range of a vector of symbols.
+
+class Dynobj::Symbol_hasher : public Parallel_runner
+{
+ public:
+  Symbol_hasher(const std::vector<Symbol*>& syms, Hash_function hash,
+		std::vector<uint32_t>* hashvals, unsigned int parts)
+    : syms_(syms), hash_(hash), hashvals_(hashvals), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t count = this->syms_.size();
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? count
+		  : count / this->parts_ * (part + 1));
+    for (size_t i = begin; i < end; ++i)
+      (*this->hashvals_)[i] = this->hash_(this->syms_[i]->name());
+  }
+
+ private:
+  const std::vector<Symbol*>& syms_;
+  Hash_function hash_;
+  std::vector<uint32_t>* hashvals_;
+  unsigned int parts_;
+};
+
+// Set HASHVALS to the hash codes of the names of SYMS.  A large
+// dynamic symbol table is hashed on all the threads.
+
+void
+Dynobj::hash_symbols(const std::vector<Symbol*>& syms, Hash_function hash,
+		     std::vector<uint32_t>* hashvals)
+{
+  size_t count = syms.size();
+  hashvals->resize(count);
+  unsigned int parts = std::max(1U,
+				std::min(Workqueue::parallel_thread_count(),
+					 static_cast<unsigned int>(count
+								   / 4096)));
+  Symbol_hasher hasher(syms, hash, hashvals, parts);
+  Workqueue::run_in_parallel(&hasher, parts);
+}
+
 // The standard ELF hash function.  This hash function must not
 // change, as the dynamic linker uses it also.
 
@@ -906,9 +980,8 @@ Dynobj::create_elf_hash_table(const std::vector<Symbol*>& dynsyms,
   unsigned int dynsym_count = dynsyms.size();
 
   // Get the hash values for all the symbols.
-  std::vector<uint32_t> dynsym_hashvals(dynsym_count);
-  for (unsigned int i = 0; i < dynsym_count; ++i)
-    dynsym_hashvals[i] = Dynobj::elf_hash(dynsyms[i]->name());
+  std::vector<uint32_t> dynsym_hashvals;
+  Dynobj::hash_symbols(dynsyms, Dynobj::elf_hash, &dynsym_hashvals);
 
   const unsigned int bucketcount =
     Dynobj::compute_bucket_count(dynsym_hashvals, false);
@@ -1022,7 +1095,7 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
   // not want to put into the hash table we store into
   // UNHASHED_DYNSYMS.  Symbols which we do want to store we put into
   // HASHED_DYNSYMS.  DYNSYM_HASHVALS is parallel to HASHED_DYNSYMS,
-  // and records the hash codes.
+  // and records the hash codes, which we compute afterward.
 
   std::vector<Symbol*> unhashed_dynsyms;
   unhashed_dynsyms.reserve(count);
@@ -1030,9 +1103,6 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
   std::vector<Symbol*> hashed_dynsyms;
   hashed_dynsyms.reserve(count);
 
-  std::vector<uint32_t> dynsym_hashvals;
-  dynsym_hashvals.reserve(count);
-  
   for (unsigned int i = 0; i < count; ++i)
     {
       Symbol* sym = dynsyms[i];
@@ -1043,12 +1113,12 @@ Dynobj::create_gnu_hash_table(const std::vector<Symbol*>& dynsyms,
 	      || sym->is_forced_local()))
 	unhashed_dynsyms.push_back(sym);
       else
-	{
-	  hashed_dynsyms.push_back(sym);
-	  dynsym_hashvals.push_back(Dynobj::gnu_hash(sym->name()));
-	}
+	hashed_dynsyms.push_back(sym);
     }
 
+  std::vector<uint32_t> dynsym_hashvals;
+  Dynobj::hash_symbols(hashed_dynsyms, Dynobj::gnu_hash, &dynsym_hashvals);
+
   // Put the unhashed symbols at the start of the global portion of
   // the dynamic symbol table.
   const unsigned int unhashed_count = unhashed_dynsyms.size();
@@ -1162,19 +1232,36 @@ Dynobj::sized_create_gnu_hash_table(
 
   const unsigned int nsyms = hashed_dynsyms.size();
 
+  // Choose the size of the bloom filter.  By default we use between
+  // about 5 and 11 bits per symbol, as GNU ld does.  --hash-bloom-bits
+  // asks for a number of bits per symbol; a bigger filter lets the
+  // dynamic linker reject more lookups without walking a chain.
   uint32_t maskbitslog2 = 1;
-  uint32_t x = nsyms >> 1;
-  while (x != 0)
+  const unsigned int bloom_bits = parameters->options().hash_bloom_bits();
+  if (bloom_bits != 0)
     {
-      ++maskbitslog2;
-      x >>= 1;
+      uint64_t want = static_cast<uint64_t>(nsyms) * bloom_bits;
+      while (maskbitslog2 < 31
+	     && (static_cast<uint64_t>(1) << maskbitslog2) < want)
+	++maskbitslog2;
+      if (maskbitslog2 < 5)
+	maskbitslog2 = 5;
     }
-  if (maskbitslog2 < 3)
-    maskbitslog2 = 5;
-  else if (((1U << (maskbitslog2 - 2)) & nsyms) != 0)
-    maskbitslog2 += 3;
   else
-    maskbitslog2 += 2;
+    {
+      uint32_t x = nsyms >> 1;
+      while (x != 0)
+	{
+	  ++maskbitslog2;
+	  x >>= 1;
+	}
+      if (maskbitslog2 < 3)
+	maskbitslog2 = 5;
+      else if (((1U << (maskbitslog2 - 2)) & nsyms) != 0)
+	maskbitslog2 += 3;
+      else
+	maskbitslog2 += 2;
+    }
 
   uint32_t shift1;
   if (size == 32)
@@ -1584,6 +1671,20 @@ Versions::add_need(Stringpool* dynpool, const char* filename, const char* name,
   ins.first->second = vn->add_name(name);
 }
 
+// Add a reference to version NAME in DYNOBJ which is not associated
+// with any symbol.
+
+void
+Versions::record_need(Stringpool* dynpool, const Dynobj* dynobj,
+		      const char* name)
+{
+  gold_assert(!this->is_finalized_);
+
+  Stringpool::Key name_key;
+  name = dynpool->add(name, true, &name_key);
+  this->add_need(dynpool, dynobj->soname(), name, name_key);
+}
+
 // Set the version indexes.  Create a new dynamic version symbol for
 // each new version definition.
 
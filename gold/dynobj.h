@@ -72,6 +72,13 @@ class Dynobj : public Object
     this->unknown_needed_ = set ? UNKNOWN_NEEDED_TRUE : UNKNOWN_NEEDED_FALSE;
   }
 
+  // Return whether this dynamic object defines the version
+  // GLIBC_ABI_DT_RELR, which tells us that its dynamic linker
+  // supports DT_RELR.
+  bool
+  defines_relr_version() const
+  { return this->defines_relr_version_; }
+
   // Compute the ELF hash code for a string.
   static uint32_t
   elf_hash(const char*);
@@ -111,11 +118,31 @@ class Dynobj : public Object
   add_needed(const char* s)
   { this->needed_.push_back(std::string(s)); }
 
+  // Note that this dynamic object defines GLIBC_ABI_DT_RELR.
+  void
+  set_defines_relr_version()
+  { this->defines_relr_version_ = true; }
+
  private:
+  // A Parallel_runner used to compute the hash codes of symbol names.
+  class Symbol_hasher;
+
+  // A hash function for symbol names.
+  typedef uint32_t (*Hash_function)(const char*);
+
   // Compute the GNU hash code for a string.
   static uint32_t
   gnu_hash(const char*);
 
+  // Set HASHVALS to the hash codes of the names of SYMS.
+  static void
+  hash_symbols(const std::vector<Symbol*>& syms, Hash_function hash,
+	       std::vector<uint32_t>* hashvals);
+
+  // Return whether an odd number is prime.
+  static bool
+  is_prime(unsigned int);
+
   // Compute the number of hash buckets to use.
   static unsigned int
   compute_bucket_count(const std::vector<uint32_t>& hashcodes,
@@ -153,6 +180,8 @@ class Dynobj : public Object
   // Whether this dynamic object has any DT_NEEDED entries not seen
   // during the link.
   Unknown_needed unknown_needed_;
+  // Whether this dynamic object defines GLIBC_ABI_DT_RELR.
+  bool defines_relr_version_;
 };
 
 // A dynamic object, size and endian specific version.
@@ -305,11 +334,11 @@ class Sized_dynobj : public Dynobj
 
   // Create the version map.
   void
-  make_version_map(Read_symbols_data* sd, Version_map*) const;
+  make_version_map(Read_symbols_data* sd, Version_map*);
 
   // Add version definitions to the version map.
   void
-  make_verdef_map(Read_symbols_data* sd, Version_map*) const;
+  make_verdef_map(Read_symbols_data* sd, Version_map*);
 
   // Add version references to the version map.
   void
@@ -583,6 +612,11 @@ class Versions
   need_section_contents(const Stringpool*, unsigned char**,
 			unsigned int* psize, unsigned int* pentries) const;
 
+  // Add a reference to version NAME in the dynamic object DYNOBJ,
+  // which does not come from any symbol.
+  void
+  record_need(Stringpool*, const Dynobj* dynobj, const char* name);
+
   const Version_script_info&
   version_script() const
   { return this->version_script_; }
@@ -29,6 +29,7 @@
 #include "dwarf.h"
 #include "symtab.h"
 #include "reloc.h"
+#include "workqueue.h"
 #include "ehframe.h"
 
 namespace gold
@@ -188,8 +189,8 @@ Eh_frame_hdr::do_sized_write(Output_file* of)
       this->get_fde_addresses<size, big_endian>(of, &this->fde_offsets_,
 						&fde_addresses);
 
-      std::sort(fde_addresses.begin(), fde_addresses.end(),
-		Fde_address_compare<size>());
+      parallel_sort(fde_addresses.begin(), fde_addresses.end(),
+		    Fde_address_compare<size>());
 
       typename elfcpp::Elf_types<size>::Elf_Addr output_address;
       output_address = this->address();
@@ -284,11 +285,58 @@ Eh_frame_hdr::get_fde_pc(
   return pc;
 }
 
+// Class Eh_frame_hdr::Fde_address_reader.  Part I of this converts
+// the Ith range of FDE_OFFSETS to FDE addresses.
+
+template<int size, bool big_endian>
+class Eh_frame_hdr::Fde_address_reader : public Parallel_runner
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Fde_address_reader(Eh_frame_hdr* hdr, Address eh_frame_address,
+		     const unsigned char* eh_frame_contents,
+		     const Fde_offsets* fde_offsets,
+		     Fde_addresses<size>* fde_addresses, unsigned int parts)
+    : hdr_(hdr), eh_frame_address_(eh_frame_address),
+      eh_frame_contents_(eh_frame_contents), fde_offsets_(fde_offsets),
+      fde_addresses_(fde_addresses), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t count = this->fde_offsets_->size();
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? count
+		  : count / this->parts_ * (part + 1));
+    for (size_t i = begin; i < end; ++i)
+      {
+	const Fde_offset& fde((*this->fde_offsets_)[i]);
+	Address fde_pc;
+	fde_pc = this->hdr_->get_fde_pc<size, big_endian>(
+	    this->eh_frame_address_, this->eh_frame_contents_,
+	    fde.first, fde.second);
+	this->fde_addresses_->set(i, fde_pc,
+				  this->eh_frame_address_ + fde.first);
+      }
+  }
+
+ private:
+  Eh_frame_hdr* hdr_;
+  Address eh_frame_address_;
+  const unsigned char* eh_frame_contents_;
+  const Fde_offsets* fde_offsets_;
+  Fde_addresses<size>* fde_addresses_;
+  unsigned int parts_;
+};
+
 // Given an array of FDE offsets in the .eh_frame section, return an
 // array of offsets from the exception frame header to the FDE's
 // output PC and to the output address of the FDE itself.  We get the
 // FDE's PC by actually looking in the .eh_frame section we just wrote
-// to the output file.
+// to the output file.  This is done on all the threads.
 
 template<int size, bool big_endian>
 void
@@ -303,16 +351,14 @@ Eh_frame_hdr::get_fde_addresses(Output_file* of,
   const unsigned char* eh_frame_contents = of->get_input_view(eh_frame_offset,
 							      eh_frame_size);
 
-  for (Fde_offsets::const_iterator p = fde_offsets->begin();
-       p != fde_offsets->end();
-       ++p)
-    {
-      typename elfcpp::Elf_types<size>::Elf_Addr fde_pc;
-      fde_pc = this->get_fde_pc<size, big_endian>(eh_frame_address,
-						  eh_frame_contents,
-						  p->first, p->second);
-      fde_addresses->push_back(fde_pc, eh_frame_address + p->first);
-    }
+  unsigned int parts =
+    std::max(1U,
+	     std::min(Workqueue::parallel_thread_count(),
+		      static_cast<unsigned int>(fde_offsets->size() / 8192)));
+  Fde_address_reader<size, big_endian> reader(this, eh_frame_address,
+					      eh_frame_contents, fde_offsets,
+					      fde_addresses, parts);
+  Workqueue::run_in_parallel(&reader, parts);
 
   of->free_input_view(eh_frame_offset, eh_frame_size, eh_frame_contents);
 }
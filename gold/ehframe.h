@@ -106,15 +106,14 @@ class Eh_frame_hdr : public Output_section_data
     typedef typename std::vector<Fde_address> Fde_address_list;
     typedef typename Fde_address_list::iterator iterator;
 
-    Fde_addresses(unsigned int reserve)
-      : fde_addresses_()
-    { this->fde_addresses_.reserve(reserve); }
+    Fde_addresses(unsigned int count)
+      : fde_addresses_(count)
+    { }
 
+    // Set entry I.  Different entries may be set at the same time.
     void
-    push_back(Address pc_address, Address fde_address)
-    {
-      this->fde_addresses_.push_back(std::make_pair(pc_address, fde_address));
-    }
+    set(unsigned int i, Address pc_address, Address fde_address)
+    { this->fde_addresses_[i] = std::make_pair(pc_address, fde_address); }
 
     iterator
     begin()
@@ -128,16 +127,25 @@ class Eh_frame_hdr : public Output_section_data
     Fde_address_list fde_addresses_;
   };
 
-  // Compare Fde_address objects.
+  // Compare Fde_address objects.  FDEs with the same PC are ordered by
+  // address, so that the table does not depend on how it was sorted.
   template<int size>
   struct Fde_address_compare
   {
     bool
     operator()(const typename Fde_addresses<size>::Fde_address& f1,
 	       const typename Fde_addresses<size>::Fde_address& f2) const
-    { return f1.first < f2.first; }
+    {
+      if (f1.first != f2.first)
+	return f1.first < f2.first;
+      return f1.second < f2.second;
+    }
   };
 
+  // A Parallel_runner used by get_fde_addresses.
+  template<int size, bool big_endian>
+  class Fde_address_reader;
+
   // Return the PC to which an FDE refers.
   template<int size, bool big_endian>
   typename elfcpp::Elf_types<size>::Elf_Addr
@@ -24,6 +24,7 @@
 
 #include <cstring>
 #include <cerrno>
+#include <algorithm>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
@@ -54,6 +55,19 @@ readv(int, const iovec*, int)
 }
 #endif
 
+#ifndef HAVE_POSIX_FADVISE
+// Reading ahead is only a hint, so do nothing if the system does not
+// support it.
+#ifndef POSIX_FADV_WILLNEED
+#define POSIX_FADV_WILLNEED 0
+#endif
+static int
+posix_fadvise(int, off_t, off_t, int)
+{
+  return 0;
+}
+#endif // !defined(HAVE_POSIX_FADVISE)
+
 namespace gold
 {
 
@@ -117,6 +131,36 @@ get_mtime(const char* filename, Timespec* mtime)
   return true;
 }
 
+// Ask the system to start reading the parts of an unopened file which
+// a link reads first.  The symbol table of an archive is at the start
+// of the file.  The section headers, symbol table and string table of
+// an object are usually at the end.  A small file is read ahead
+// entirely.
+
+void
+readahead_file(const char* filename)
+{
+  int o = ::open(filename, O_RDONLY);
+  if (o < 0)
+    return;
+
+  struct stat file_stat;
+  if (::fstat(o, &file_stat) == 0 && S_ISREG(file_stat.st_mode))
+    {
+      const off_t window = 256 * 1024;
+      off_t size = file_stat.st_size;
+      if (size <= 2 * window)
+	::posix_fadvise(o, 0, size, POSIX_FADV_WILLNEED);
+      else
+	{
+	  ::posix_fadvise(o, 0, window, POSIX_FADV_WILLNEED);
+	  ::posix_fadvise(o, size - window, window, POSIX_FADV_WILLNEED);
+	}
+    }
+
+  ::close(o);
+}
+
 // Class File_read.
 
 // A lock for the File_read static variables.
@@ -242,6 +286,25 @@ File_read::release()
   this->released_ = true;
 }
 
+// Allow several threads to read the file at once.
+
+void
+File_read::start_concurrent_reads()
+{
+  gold_assert(this->is_locked() && this->read_lock_ == NULL);
+  this->read_lock_ = new Lock();
+}
+
+// Go back to reading the file from one thread.
+
+void
+File_read::end_concurrent_reads()
+{
+  gold_assert(this->read_lock_ != NULL);
+  delete this->read_lock_;
+  this->read_lock_ = NULL;
+}
+
 // Lock the file.
 
 void
@@ -363,6 +426,15 @@ File_read::do_read(off_t start, section_size_type size, void* p)
 
 void
 File_read::read(off_t start, section_size_type size, void* p)
+{
+  Hold_optional_lock hl(this->read_lock_);
+  this->do_read_from_views(start, size, p);
+}
+
+// Read data from the file, using a view if there is one.
+
+void
+File_read::do_read_from_views(off_t start, section_size_type size, void* p)
 {
   const File_read::View* pv = this->find_view(start, size, -1U, NULL);
   if (pv != NULL)
@@ -542,6 +614,7 @@ const unsigned char*
 File_read::get_view(off_t offset, off_t start, section_size_type size,
 		    bool aligned, bool cache)
 {
+  Hold_optional_lock hl(this->read_lock_);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   return pv->data() + (offset + start - pv->start() + pv->byteshift());
@@ -551,6 +624,7 @@ File_view*
 File_read::get_lasting_view(off_t offset, off_t start, section_size_type size,
 			    bool aligned, bool cache)
 {
+  Hold_optional_lock hl(this->read_lock_);
   File_read::View* pv = this->find_or_make_view(offset, start, size,
 						aligned, cache);
   pv->lock();
@@ -622,6 +696,7 @@ File_read::do_readv(off_t base, const Read_multiple& rm, size_t start,
 void
 File_read::read_multiple(off_t base, const Read_multiple& rm)
 {
+  Hold_optional_lock hl(this->read_lock_);
   size_t count = rm.size();
   size_t i = 0;
   while (i < count)
@@ -646,7 +721,7 @@ File_read::read_multiple(off_t base, const Read_multiple& rm)
 	}
 
       if (j == i + 1)
-	this->read(base + i_off, i_entry.size, i_entry.buffer);
+	this->do_read_from_views(base + i_off, i_entry.size, i_entry.buffer);
       else
 	{
 	  File_read::View* view = this->find_view(base + i_off,
@@ -678,6 +753,48 @@ File_read::read_multiple(off_t base, const Read_multiple& rm)
     }
 }
 
+// Ask the system to start reading several pieces of the file.  Pieces
+// which are close together are merged, to keep down the number of
+// system calls for an object with many small sections.
+
+void
+File_read::readahead(off_t base, Readahead* ra)
+{
+  // There is nothing to read for a file which is already in memory.
+  if (ra->empty() || this->descriptor_ < 0)
+    return;
+
+  Hold_optional_lock hl(this->read_lock_);
+
+  std::sort(ra->begin(), ra->end());
+
+  this->reopen_descriptor();
+
+  size_t count = ra->size();
+  size_t i = 0;
+  while (i < count)
+    {
+      off_t start = (*ra)[i].file_offset;
+      off_t end = start + (*ra)[i].size;
+      size_t j;
+      for (j = i + 1; j < count; ++j)
+	{
+	  const Readahead_entry& j_entry((*ra)[j]);
+	  if (j_entry.file_offset - end >= File_read::readahead_gap)
+	    break;
+	  end = std::max(end,
+			 static_cast<off_t>(j_entry.file_offset
+					    + j_entry.size));
+	}
+
+      if (end > start)
+	::posix_fadvise(this->descriptor_, base + start, end - start,
+			POSIX_FADV_WILLNEED);
+
+      i = j;
+    }
+}
+
 // Mark all views as no longer cached.
 
 void
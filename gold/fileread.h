@@ -35,6 +35,8 @@
 namespace gold
 {
 
+class Lock;
+
 // Since not all system supports stat.st_mtim and struct timespec,
 // we define our own structure and fill the nanoseconds if we can.
 
@@ -58,6 +60,13 @@ struct Timespec
 bool
 get_mtime(const char* filename, Timespec* mtime);
 
+// Ask the system to start reading the parts of the unopened file
+// FILENAME which a link reads first, without waiting for the data.
+// This does nothing if the file can not be opened.
+
+void
+readahead_file(const char* filename);
+
 class Position_dependent_options;
 class Input_file_argument;
 class Dirsearch;
@@ -72,7 +81,7 @@ class File_read
   File_read()
     : name_(), descriptor_(-1), is_descriptor_opened_(false), object_count_(0),
       size_(0), token_(false), views_(), saved_views_(), mapped_bytes_(0),
-      released_(true), whole_file_view_(NULL)
+      released_(true), whole_file_view_(NULL), read_lock_(NULL)
   { }
 
   ~File_read();
@@ -137,6 +146,17 @@ class File_read
   filesize() const
   { return this->size_; }
 
+  // Allow several threads to read the file at once while the file is
+  // locked, as when reading the symbols of several archive members.
+  // This covers get_view, read, get_lasting_view, read_multiple and
+  // readahead, which then serialize on a lock.  Other uses of the file
+  // must wait until end_concurrent_reads is called.
+  void
+  start_concurrent_reads();
+
+  void
+  end_concurrent_reads();
+
   // Return a view into the file starting at file offset START for
   // SIZE bytes.  OFFSET is the offset into the input file for the
   // file we are reading; this is zero for a normal object file,
@@ -202,6 +222,33 @@ class File_read
   void
   read_multiple(off_t base, const Read_multiple&);
 
+  // A piece of the file to read ahead.
+  struct Readahead_entry
+  {
+    // The file offset of the data to read.
+    off_t file_offset;
+    // The amount of data to read.
+    section_size_type size;
+
+    Readahead_entry(off_t o, section_size_type s)
+      : file_offset(o), size(s)
+    { }
+
+    bool
+    operator<(const Readahead_entry& e) const
+    { return this->file_offset < e.file_offset; }
+  };
+
+  typedef std::vector<Readahead_entry> Readahead;
+
+  // Ask the system to start reading the pieces of the file in the
+  // vector in the background, so that later reads and views of them
+  // do not wait for the disk.  This does not wait for the data.  BASE
+  // is a base offset to be added to all the offsets in the vector.
+  // This sorts the vector.
+  void
+  readahead(off_t base, Readahead*);
+
   // Dump statistical information to stderr.
   static void
   print_stats();
@@ -391,6 +438,10 @@ class File_read
   void
   clear_views(Clear_views_mode);
 
+  // Read data from the file, with the read lock held if there is one.
+  void
+  do_read_from_views(off_t start, section_size_type size, void* p);
+
   // The size of a file page for buffering data.
   static const off_t page_size = 8192;
 
@@ -413,6 +464,10 @@ class File_read
   static const size_t max_readv_entries = 1;
 #endif
 
+  // Pieces to read ahead which are less than this far apart are read
+  // ahead together, along with the gap between them.
+  static const off_t readahead_gap = 64 * 1024;
+
   // Use readv to read data.
   void
   do_readv(off_t base, const Read_multiple&, size_t start, size_t count);
@@ -447,6 +502,9 @@ class File_read
   // - The contents was specified in the constructor.  Used only for
   //   testing purposes).
   View* whole_file_view_;
+  // A lock for reading the file from several threads, or NULL.  See
+  // start_concurrent_reads.
+  Lock* read_lock_;
 };
 
 // A view of file data that persists even when the file is unlocked.
@@ -25,48 +25,126 @@
 #include "object.h"
 #include "gc.h"
 #include "symtab.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
+// Mark the section with index INDEX as referenced.  Return true if it
+// was not already marked.
+
+bool
+Garbage_collection::mark_referenced(unsigned int index)
+{
+  uint32_t* word = &this->referenced_[index / 32];
+  uint32_t bit = 1U << (index % 32);
+  if ((*word & bit) != 0)
+    return false;
+#if defined(ENABLE_THREADS) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+  return (__sync_fetch_and_or(word, bit) & bit) == 0;
+#else
+  *word |= bit;
+  return true;
+#endif
+}
+
+// Class Garbage_collection::Marker.  Part I of this scans the
+// references from the Ith range of the sections in FRONTIER, marks
+// the sections they refer to, and adds the newly marked ones to the
+// Ith list in NEXT.
+
+class Garbage_collection::Marker : public Parallel_runner
+{
+ public:
+  Marker(Garbage_collection* gc, const std::vector<Section_id>& frontier,
+	 std::vector<std::vector<Section_id> >* next, unsigned int parts)
+    : gc_(gc), frontier_(frontier), next_(next), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    const Section_ref& section_reloc_map(this->gc_->section_reloc_map_);
+    std::vector<Section_id>& next((*this->next_)[part]);
+    size_t count = this->frontier_.size();
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? count
+		  : count / this->parts_ * (part + 1));
+    for (size_t i = begin; i < end; ++i)
+      {
+	Section_ref::const_iterator find_it =
+	  section_reloc_map.find(this->frontier_[i]);
+	if (find_it == section_reloc_map.end())
+	  continue;
+	const Sections_reachable& v(find_it->second);
+	for (Sections_reachable::const_iterator it_v = v.begin();
+	     it_v != v.end();
+	     ++it_v)
+	  {
+	    if (this->gc_->mark_referenced(this->gc_->section_index(*it_v)))
+	      next.push_back(*it_v);
+	  }
+      }
+  }
+
+ private:
+  Garbage_collection* gc_;
+  const std::vector<Section_id>& frontier_;
+  std::vector<std::vector<Section_id> >* next_;
+  unsigned int parts_;
+};
+
 // Garbage collection uses a worklist style algorithm to determine the 
-// transitive closure of all referenced sections.
+// transitive closure of all referenced sections.  Each round scans
+// the sections first marked in the previous round, split across the
+// threads.  A section is marked by setting its bit in REFERENCED_,
+// so only the thread which sets the bit adds it to the next round.
+
 void 
 Garbage_collection::do_transitive_closure()
 {
+  std::vector<Section_id> frontier;
   while (!this->worklist().empty())
     {
-      // Add elements from the work list to the referenced list
-      // one by one.
       Section_id entry = this->worklist().front();
       this->worklist().pop();
-      if (this->referenced_list().find(entry)
-          == this->referenced_list().end()) 
-        {
-          this->referenced_list().insert(entry);
-        }
-      else
-        {
-          continue;
-        }
-      Garbage_collection::Section_ref::iterator find_it = 
-                this->section_reloc_map().find(entry);
-      if (find_it == this->section_reloc_map().end()) 
-          continue;
-      Garbage_collection::Sections_reachable v = find_it->second;
-      // Scan the vector of references for each work_list entry. 
-      for (Garbage_collection::Sections_reachable::iterator it_v = v.begin();
-           it_v != v.end();
-           ++it_v)
-        {
-          // Do not add already processed sections to the work_list. 
-          if (this->referenced_list().find(*it_v)
-              == this->referenced_list().end())
-            {
-              this->worklist().push(*it_v);   
-            }
-        }
+      this->add_object(entry.first);
+      frontier.push_back(entry);
     }
+
+  this->referenced_.assign((this->section_count_ + 31) / 32, 0);
+
+  // Mark the initial entries, dropping duplicates.
+  size_t count = 0;
+  for (size_t i = 0; i < frontier.size(); ++i)
+    if (this->mark_referenced(this->section_index(frontier[i])))
+      frontier[count++] = frontier[i];
+  frontier.resize(count);
+
+#if defined(ENABLE_THREADS) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+  unsigned int max_parts = Workqueue::parallel_thread_count();
+#else
+  unsigned int max_parts = 1;
+#endif
+
+  std::vector<std::vector<Section_id> > next;
+  while (!frontier.empty())
+    {
+      unsigned int parts =
+	std::max(1U, std::min(max_parts,
+			      static_cast<unsigned int>(frontier.size()
+							/ 256)));
+      next.clear();
+      next.resize(parts);
+      Marker marker(this, frontier, &next, parts);
+      Workqueue::run_in_parallel(&marker, parts);
+
+      frontier.clear();
+      for (unsigned int i = 0; i < parts; ++i)
+	frontier.insert(frontier.end(), next[i].begin(), next[i].end());
+    }
+
   this->worklist_ready();
 }
 
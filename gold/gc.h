@@ -59,15 +59,12 @@ class Garbage_collection
   typedef std::map<std::string, Sections_reachable> Cident_section_map;
 
   Garbage_collection()
-  : is_worklist_ready_(false)
+  : is_worklist_ready_(false), section_bases_(), section_count_(0),
+    referenced_()
   { }
 
   // Accessor methods for the private members.
 
-  Sections_reachable&
-  referenced_list()
-  { return referenced_list_; }
-
   Section_ref&
   section_reloc_map()
   { return this->section_reloc_map_; }
@@ -89,8 +86,14 @@ class Garbage_collection
 
   bool
   is_section_garbage(Object* obj, unsigned int shndx)
-  { return (this->referenced_list().find(Section_id(obj, shndx))
-            == this->referenced_list().end()); }
+  {
+    Section_bases::const_iterator p = this->section_bases_.find(obj);
+    if (p == this->section_bases_.end())
+      return true;
+    unsigned int index = p->second + shndx;
+    return (index / 32 >= this->referenced_.size()
+	    || (this->referenced_[index / 32] & (1U << (index % 32))) == 0);
+  }
 
   Cident_section_map*
   cident_sections()
@@ -99,7 +102,10 @@ class Garbage_collection
   void
   add_cident_section(std::string section_name,
 		     Section_id secn)
-  { this->cident_sections_[section_name].insert(secn); }
+  {
+    this->add_object(secn.first);
+    this->cident_sections_[section_name].insert(secn);
+  }
 
   // Add a reference from the SRC_SHNDX-th section of SRC_OBJECT to
   // DST_SHNDX-th section of DST_OBJECT.
@@ -107,6 +113,8 @@ class Garbage_collection
   add_reference(Object* src_object, unsigned int src_shndx,
 		Object* dst_object, unsigned int dst_shndx)
   {
+    this->add_object(src_object);
+    this->add_object(dst_object);
     Section_id src_id(src_object, src_shndx);
     Section_id dst_id(dst_object, dst_shndx);
     Section_ref::iterator p = this->section_reloc_map_.find(src_id);
@@ -117,12 +125,50 @@ class Garbage_collection
   }
 
  private:
+  // A Parallel_runner used by do_transitive_closure.
+  class Marker;
+
+  // Map from an object to the index of its first section in the
+  // REFERENCED_ bits.
+  typedef Unordered_map<const Object*, unsigned int> Section_bases;
+
+  // Give the sections of OBJECT indexes in the REFERENCED_ bits, if
+  // that has not already been done.
+  void
+  add_object(const Object* object)
+  {
+    std::pair<Section_bases::iterator, bool> ins =
+      this->section_bases_.insert(std::make_pair(object,
+						 this->section_count_));
+    if (ins.second)
+      this->section_count_ += object->shnum();
+  }
+
+  // Return the index of section SECN in the REFERENCED_ bits.
+  unsigned int
+  section_index(const Section_id& secn) const
+  {
+    Section_bases::const_iterator p = this->section_bases_.find(secn.first);
+    gold_assert(p != this->section_bases_.end());
+    return p->second + secn.second;
+  }
+
+  // Mark the section with index INDEX as referenced.  Return true if
+  // it was not already marked.  This may be called by several
+  // threads at once.
+  bool
+  mark_referenced(unsigned int index);
 
   Worklist_type work_list_;
   bool is_worklist_ready_;
   Section_ref section_reloc_map_;
-  Sections_reachable referenced_list_;
   Cident_section_map cident_sections_;
+  // Index of the first section of each object in REFERENCED_.
+  Section_bases section_bases_;
+  // The number of sections given indexes in REFERENCED_.
+  unsigned int section_count_;
+  // One bit for each section, set if the section is referenced.
+  std::vector<uint32_t> referenced_;
 };
 
 // Data to pass between successive invocations of do_layout
@@ -237,6 +237,12 @@ queue_initial_tasks(const General_options& options,
   Task_token* this_blocker = NULL;
   if (ibase == NULL)
     {
+      // Start reading the input files in the background.  This task
+      // is queued first so that it runs before the first Read_symbols
+      // task, even if we are not using threads.
+      if (options.readahead())
+	workqueue->queue(new Readahead_inputs(&cmdline));
+
       // Normal link.  Queue a Read_symbols task for each input file
       // on the command line.
       for (Command_line::const_iterator p = cmdline.begin();
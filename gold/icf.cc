@@ -147,10 +147,76 @@
 #include "demangle.h"
 #include "elfcpp.h"
 #include "int_encoding.h"
+#include "workqueue.h"
 
 namespace gold
 {
 
+// The state kept for each candidate section between iterations of
+// match_sections.
+
+struct Icf_section_info
+{
+  // The section's text and relocs to sections that cannot be folded.
+  // This does not change after the first iteration.
+  std::string contents;
+  // The hash of CONTENTS.
+  uint64_t contents_hash;
+  // The relocs to sections that could be folded, using the kept
+  // section of each target.
+  std::string icf_relocs;
+  // The hash of CONTENTS followed by ICF_RELOCS.
+  uint64_t hash;
+  // The ids of the sections that could be folded which are pointed
+  // to by relocs, in the order they appear in ICF_RELOCS.
+  std::vector<unsigned int> tracked;
+  // The kept section of each entry in TRACKED when ICF_RELOCS was
+  // computed.
+  std::vector<unsigned int> tracked_kept;
+
+  Icf_section_info()
+    : contents(), contents_hash(0), icf_relocs(), hash(0), tracked(),
+      tracked_kept()
+  { }
+};
+
+// The initial value for icf_hash.
+
+static const uint64_t icf_hash_init = 14695981039346656037ULL;
+
+// Return the 64-bit FNV-1a hash of the LEN bytes at P, continuing
+// from the hash H.
+
+static inline uint64_t
+icf_hash(const unsigned char* p, size_t len, uint64_t h)
+{
+  for (size_t i = 0; i < len; ++i)
+    {
+      h ^= p[i];
+      h *= 1099511628211ULL;
+    }
+  return h;
+}
+
+static inline uint64_t
+icf_hash(const std::string& s, uint64_t h)
+{
+  return icf_hash(reinterpret_cast<const unsigned char*>(s.data()),
+                  s.length(), h);
+}
+
+// Free the memory used by the contents of a section which will not be
+// compared with any other section again.  The hashes are kept.
+
+static void
+release_section_info(Icf_section_info* info)
+{
+  std::string().swap(info->contents);
+  std::string().swap(info->icf_relocs);
+  std::vector<unsigned int>().swap(info->tracked);
+  std::vector<unsigned int>().swap(info->tracked_kept);
+}
+
 // This function determines if a section or a group of identical
 // sections has unique contents.  Such unique sections or groups can be
 // declared final and need not be processed any further.
@@ -158,18 +224,19 @@ namespace gold
 // ID_SECTION : Vector mapping a section index to a Section_id pair.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sections is already known to be unique.
-// SECTION_CONTENTS : Contains the section's text and relocs to sections
-//                    that cannot be folded.   SECTION_CONTENTS are NULL
-//                    implies that this function is being called for the
-//                    first time before the first iteration of icf.
+// SECTION_INFO : Contains the hash of the section's text and relocs to
+//                sections that cannot be folded.   SECTION_INFO is NULL
+//                implies that this function is being called for the
+//                first time before the first iteration of icf.
 
 static void
 preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
                                std::vector<bool>* is_secn_or_group_unique,
-                               std::vector<std::string>* section_contents)
+                               const std::vector<Icf_section_info>*
+                                 section_info)
 {
-  Unordered_map<uint32_t, unsigned int> uniq_map;
-  std::pair<Unordered_map<uint32_t, unsigned int>::iterator, bool>
+  Unordered_map<uint64_t, unsigned int> uniq_map;
+  std::pair<Unordered_map<uint64_t, unsigned int>::iterator, bool>
     uniq_map_insert;
 
   for (unsigned int i = 0; i < id_section.size(); i++)
@@ -177,10 +244,10 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
       if ((*is_secn_or_group_unique)[i])
         continue;
 
-      uint32_t cksum;
+      uint64_t hash;
       Section_id secn = id_section[i];
       section_size_type plen;
-      if (section_contents == NULL)
+      if (section_info == NULL)
         {
           // Lock the object so we can read from it.  This is only called
           // single-threaded from queue_middle_tasks, so it is OK to lock.
@@ -191,16 +258,11 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
           contents = secn.first->section_contents(secn.second,
                                                   &plen,
                                                   false);
-          cksum = xcrc32(contents, plen, 0xffffffff);
+          hash = icf_hash(contents, plen, icf_hash_init);
         }
       else
-        {
-          const unsigned char* contents_array = reinterpret_cast
-            <const unsigned char*>((*section_contents)[i].c_str());
-          cksum = xcrc32(contents_array, (*section_contents)[i].length(),
-                         0xffffffff);
-        }
-      uniq_map_insert = uniq_map.insert(std::make_pair(cksum, i));
+        hash = (*section_info)[i].contents_hash;
+      uniq_map_insert = uniq_map.insert(std::make_pair(hash, i));
       if (uniq_map_insert.second)
         {
           (*is_secn_or_group_unique)[i] = true;
@@ -213,77 +275,66 @@ preprocess_for_unique_sections(const std::vector<Section_id>& id_section,
     }
 }
 
-// This returns the buffer containing the section's contents, both
-// text and relocs.  Relocs are differentiated as those pointing to
-// sections that could be folded and those that cannot.  Only relocs
-// pointing to sections that could be folded are recomputed on
-// subsequent invocations of this function.
+// This computes the section's contents, both text and relocs.
+// Relocs are differentiated as those pointing to sections that could
+// be folded and those that cannot.  Only relocs pointing to sections
+// that could be folded are recomputed on subsequent invocations of
+// this function.  On the first invocation the caller must lock the
+// object.  Later invocations do not read the object, and may be run
+// in parallel for different sections.
 // Parameters  :
 // FIRST_ITERATION    : true if it is the first invocation.
 // SECN               : Section for which contents are desired.
-// SECTION_NUM        : Unique section number of this section.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// INFO               : Store the section's text and relocs to non-ICF
+//                      sections, the relocs to ICF sections, and the
+//                      ICF sections that they point to.
 
-static std::string
+static void
 get_section_contents(bool first_iteration,
                      const Section_id& secn,
-                     unsigned int section_num,
-                     unsigned int* num_tracked_relocs,
                      Symbol_table* symtab,
                      const std::vector<unsigned int>& kept_section_id,
-                     std::vector<std::string>* section_contents)
+                     Icf_section_info* info)
 {
-  // Lock the object so we can read from it.  This is only called
-  // single-threaded from queue_middle_tasks, so it is OK to lock.
-  // Unfortunately we have no way to pass in a Task token.
-  const Task* dummy_task = reinterpret_cast<const Task*>(-1);
-  Task_lock_obj<Object> tl(dummy_task, secn.first);
-
   section_size_type plen;
   const unsigned char* contents = NULL;
   if (first_iteration)
     contents = secn.first->section_contents(secn.second, &plen, false);
 
-  // The buffer to hold all the contents including relocs.  A checksum
-  // is then computed on this buffer.
+  // The buffer to hold the contents and the relocs to sections that
+  // cannot be folded.  This is only built in the first iteration.
   std::string buffer;
-  std::string icf_reloc_buffer;
+  std::string& icf_reloc_buffer(info->icf_relocs);
 
-  if (num_tracked_relocs)
-    *num_tracked_relocs = 0;
+  icf_reloc_buffer.clear();
+  info->tracked_kept.clear();
 
   Icf::Reloc_info_list& reloc_info_list = 
     symtab->icf()->reloc_info_list();
 
-  Icf::Reloc_info_list::iterator it_reloc_info_list =
+  Icf::Reloc_info_list::const_iterator it_reloc_info_list =
     reloc_info_list.find(secn);
 
-  buffer.clear();
-  icf_reloc_buffer.clear();
-
   // Process relocs and put them into the buffer.
 
   if (it_reloc_info_list != reloc_info_list.end())
     {
-      Icf::Sections_reachable_info v =
+      const Icf::Sections_reachable_info& v =
         (it_reloc_info_list->second).section_info;
       // Stores the information of the symbol pointed to by the reloc.
-      Icf::Symbol_info s = (it_reloc_info_list->second).symbol_info;
+      const Icf::Symbol_info& s = (it_reloc_info_list->second).symbol_info;
       // Stores the addend and the symbol value.
-      Icf::Addend_info a = (it_reloc_info_list->second).addend_info;
+      const Icf::Addend_info& a = (it_reloc_info_list->second).addend_info;
       // Stores the offset of the reloc.
-      Icf::Offset_info o = (it_reloc_info_list->second).offset_info;
-      Icf::Reloc_addend_size_info reloc_addend_size_info =
+      const Icf::Offset_info& o = (it_reloc_info_list->second).offset_info;
+      const Icf::Reloc_addend_size_info& reloc_addend_size_info =
         (it_reloc_info_list->second).reloc_addend_size_info;
-      Icf::Sections_reachable_info::iterator it_v = v.begin();
-      Icf::Symbol_info::iterator it_s = s.begin();
-      Icf::Addend_info::iterator it_a = a.begin();
-      Icf::Offset_info::iterator it_o = o.begin();
-      Icf::Reloc_addend_size_info::iterator it_addend_size =
+      Icf::Sections_reachable_info::const_iterator it_v = v.begin();
+      Icf::Symbol_info::const_iterator it_s = s.begin();
+      Icf::Addend_info::const_iterator it_a = a.begin();
+      Icf::Offset_info::const_iterator it_o = o.begin();
+      Icf::Reloc_addend_size_info::const_iterator it_addend_size =
         reloc_addend_size_info.begin();
 
       for (; it_v != v.end(); ++it_v, ++it_s, ++it_a, ++it_o, ++it_addend_size)
@@ -345,11 +396,11 @@ get_section_contents(bool first_iteration,
               && section_id_map_it != section_id_map.end())
             {
               // This is a reloc to a section that might be folded.
-              if (num_tracked_relocs)
-                (*num_tracked_relocs)++;
-
               char kept_section_str[10];
               unsigned int secn_id = section_id_map_it->second;
+              if (first_iteration)
+                info->tracked.push_back(secn_id);
+              info->tracked_kept.push_back(kept_section_id[secn_id]);
               snprintf(kept_section_str, sizeof(kept_section_str), "%u",
                        kept_section_id[secn_id]);
               if (first_iteration)
@@ -507,145 +558,227 @@ get_section_contents(bool first_iteration,
       buffer.append(reinterpret_cast<const char*>(contents), plen);
       // Store the section contents that dont change to avoid recomputing
       // during the next call to this function.
-      (*section_contents)[section_num] = buffer;
+      info->contents.swap(buffer);
     }
   else
-    {
-      gold_assert(buffer.empty());
-      // Reuse the contents computed in the previous iteration.
-      buffer.append((*section_contents)[section_num]);
-    }
+    gold_assert(buffer.empty());
+}
 
-  buffer.append(icf_reloc_buffer);
-  return buffer;
+// Return whether the relocs to ICF sections in INFO are out of date,
+// because one of the sections they point to has been folded since
+// they were computed.
+
+static bool
+icf_relocs_changed(const Icf_section_info& info,
+                   const std::vector<unsigned int>& kept_section_id)
+{
+  for (size_t j = 0; j < info.tracked.size(); ++j)
+    if (kept_section_id[info.tracked[j]] != info.tracked_kept[j])
+      return true;
+  return false;
 }
 
-// This function computes a checksum on each section to detect and form
+// Compute the hashes of the contents in INFO.
+
+static void
+hash_section_info(bool first_iteration, Icf_section_info* info)
+{
+  if (first_iteration)
+    info->contents_hash = icf_hash(info->contents, icf_hash_init);
+  info->hash = icf_hash(info->icf_relocs, info->contents_hash);
+}
+
+// A Parallel_runner used by match_sections to hash the sections in
+// SECTIONS.  After the first iteration, this first recomputes the
+// relocs to ICF sections if any of the sections they point to has
+// been folded.  Part I handles the Ith range of SECTIONS.
+
+class Icf_section_hasher : public Parallel_runner
+{
+ public:
+  Icf_section_hasher(bool first_iteration, Symbol_table* symtab,
+                     const std::vector<unsigned int>& kept_section_id,
+                     const std::vector<Section_id>& id_section,
+                     const std::vector<unsigned int>& sections,
+                     std::vector<Icf_section_info>* section_info,
+                     unsigned int parts)
+    : first_iteration_(first_iteration), symtab_(symtab),
+      kept_section_id_(kept_section_id), id_section_(id_section),
+      sections_(sections), section_info_(section_info), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t count = this->sections_.size();
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+                  ? count
+                  : count / this->parts_ * (part + 1));
+    for (size_t j = begin; j < end; ++j)
+      {
+        unsigned int i = this->sections_[j];
+        Icf_section_info* info = &(*this->section_info_)[i];
+        if (!this->first_iteration_)
+          {
+            if (!icf_relocs_changed(*info, this->kept_section_id_))
+              continue;
+            get_section_contents(false, this->id_section_[i],
+                                 this->symtab_, this->kept_section_id_,
+                                 info);
+          }
+        hash_section_info(this->first_iteration_, info);
+      }
+  }
+
+ private:
+  bool first_iteration_;
+  Symbol_table* symtab_;
+  const std::vector<unsigned int>& kept_section_id_;
+  const std::vector<Section_id>& id_section_;
+  const std::vector<unsigned int>& sections_;
+  std::vector<Icf_section_info>* section_info_;
+  unsigned int parts_;
+};
+
+// This function computes a hash of each section to detect and form
 // groups of identical sections.  The first iteration does this for all 
 // sections.
 // Further iterations do this only for the kept sections from each group to
 // determine if larger groups of identical sections could be formed.  The
 // first section in each group is the kept section for that group.
 //
-// CRC32 is the checksumming algorithm and can have collisions.  That is,
-// two sections with different contents can have the same checksum. Hence,
-// a multimap is used to maintain more than one group of checksum
-// identical sections.  A section is added to a group only after its
-// contents are explicitly compared with the kept section of the group.
+// The hashes are computed in parallel.  After the first iteration,
+// only the relocs to sections that have been folded since the last
+// iteration are recomputed.  The groups are then formed in order on
+// one thread, so that the result does not depend on the number of
+// threads.  Since folding a section changes the relocs of later
+// sections that point to it, those are recomputed as they are seen.
+//
+// The hash can have collisions.  That is, two sections with different
+// contents can have the same hash.  Hence, a multimap is used to
+// maintain more than one group of hash identical sections.  A section
+// is added to a group only after its contents are explicitly compared
+// with the kept section of the group.
 //
 // Parameters  :
 // ITERATION_NUM           : Invocation instance of this function.
-// NUM_TRACKED_RELOCS : Vector reference to store the number of relocs
-//                      to ICF sections.
 // KEPT_SECTION_ID    : Vector which maps folded sections to kept sections.
 // ID_SECTION         : Vector mapping a section to an unique integer.
 // IS_SECN_OR_GROUP_UNIQUE : To check if a section or a group of identical
 //                            sectionsis already known to be unique.
-// SECTION_CONTENTS   : Store the section's text and relocs to non-ICF
-//                      sections.
+// SECTION_INFO       : Store the section's contents, relocs and hashes.
 
 static bool
 match_sections(unsigned int iteration_num,
                Symbol_table* symtab,
-               std::vector<unsigned int>* num_tracked_relocs,
                std::vector<unsigned int>* kept_section_id,
                const std::vector<Section_id>& id_section,
                std::vector<bool>* is_secn_or_group_unique,
-               std::vector<std::string>* section_contents)
+               std::vector<Icf_section_info>* section_info)
 {
-  Unordered_multimap<uint32_t, unsigned int> section_cksum;
-  std::pair<Unordered_multimap<uint32_t, unsigned int>::iterator,
-            Unordered_multimap<uint32_t, unsigned int>::iterator> key_range;
+  Unordered_multimap<uint64_t, unsigned int> section_hash;
+  std::pair<Unordered_multimap<uint64_t, unsigned int>::iterator,
+            Unordered_multimap<uint64_t, unsigned int>::iterator> key_range;
   bool converged = true;
+  bool first_iteration = iteration_num == 1;
 
-  if (iteration_num == 1)
+  if (first_iteration)
     preprocess_for_unique_sections(id_section,
                                    is_secn_or_group_unique,
                                    NULL);
   else
     preprocess_for_unique_sections(id_section,
                                    is_secn_or_group_unique,
-                                   section_contents);
-
-  std::vector<std::string> full_section_contents;
+                                   section_info);
 
+  // Find the sections to hash.  In the first iteration this also
+  // reads their contents, which must be done on one thread.
+  std::vector<unsigned int> sections;
   for (unsigned int i = 0; i < id_section.size(); i++)
     {
-      full_section_contents.push_back("");
       if ((*is_secn_or_group_unique)[i])
-        continue;
-
-      Section_id secn = id_section[i];
-      std::string this_secn_contents;
-      uint32_t cksum;
-      if (iteration_num == 1)
         {
-          unsigned int num_relocs = 0;
-          this_secn_contents = get_section_contents(true, secn, i, &num_relocs,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
-          (*num_tracked_relocs)[i] = num_relocs;
+          release_section_info(&(*section_info)[i]);
+          continue;
         }
-      else
+      if (first_iteration)
         {
-          if ((*kept_section_id)[i] != i)
-            {
-              // This section is already folded into something.  See
-              // if it should point to a different kept section.
-              unsigned int kept_section = (*kept_section_id)[i];
-              if (kept_section != (*kept_section_id)[kept_section])
-                {
-                  (*kept_section_id)[i] = (*kept_section_id)[kept_section];
-                }
-              continue;
-            }
-          this_secn_contents = get_section_contents(false, secn, i, NULL,
-                                                    symtab, (*kept_section_id),
-                                                    section_contents);
+          Section_id secn = id_section[i];
+          // Lock the object so we can read from it.  This is only called
+          // single-threaded from queue_middle_tasks, so it is OK to lock.
+          // Unfortunately we have no way to pass in a Task token.
+          const Task* dummy_task = reinterpret_cast<const Task*>(-1);
+          Task_lock_obj<Object> tl(dummy_task, secn.first);
+          get_section_contents(true, secn, symtab, (*kept_section_id),
+                               &(*section_info)[i]);
         }
+      else if ((*kept_section_id)[i] != i)
+        continue;
+      sections.push_back(i);
+    }
 
-      const unsigned char* this_secn_contents_array =
-            reinterpret_cast<const unsigned char*>(this_secn_contents.c_str());
-      cksum = xcrc32(this_secn_contents_array, this_secn_contents.length(),
-                     0xffffffff);
-      size_t count = section_cksum.count(cksum);
+  unsigned int parts = std::max(1U,
+                                std::min(Workqueue::parallel_thread_count(),
+                                         static_cast<unsigned int>(
+                                           sections.size() / 256)));
+  Icf_section_hasher hasher(first_iteration, symtab, (*kept_section_id),
+                            id_section, sections, section_info, parts);
+  Workqueue::run_in_parallel(&hasher, parts);
 
-      if (count == 0)
-        {
-          // Start a group with this cksum.
-          section_cksum.insert(std::make_pair(cksum, i));
-          full_section_contents[i] = this_secn_contents;
-        }
-      else
+  for (unsigned int i = 0; i < id_section.size(); i++)
+    {
+      if ((*is_secn_or_group_unique)[i])
+        continue;
+
+      Icf_section_info* info = &(*section_info)[i];
+      if (!first_iteration && (*kept_section_id)[i] != i)
         {
-          key_range = section_cksum.equal_range(cksum);
-          Unordered_multimap<uint32_t, unsigned int>::iterator it;
-          // Search all the groups with this cksum for a match.
-          for (it = key_range.first; it != key_range.second; ++it)
-            {
-              unsigned int kept_section = it->second;
-              if (full_section_contents[kept_section].length()
-                  != this_secn_contents.length())
-                  continue;
-              if (memcmp(full_section_contents[kept_section].c_str(),
-                         this_secn_contents.c_str(),
-                         this_secn_contents.length()) != 0)
-                  continue;
-              (*kept_section_id)[i] = kept_section;
-              converged = false;
-              break;
-            }
-          if (it == key_range.second)
+          // This section is already folded into something.  See
+          // if it should point to a different kept section.
+          unsigned int kept_section = (*kept_section_id)[i];
+          if (kept_section != (*kept_section_id)[kept_section])
             {
-              // Create a new group for this cksum.
-              section_cksum.insert(std::make_pair(cksum, i));
-              full_section_contents[i] = this_secn_contents;
+              (*kept_section_id)[i] = (*kept_section_id)[kept_section];
             }
+          continue;
+        }
+
+      // A section folded earlier in this loop may change the relocs
+      // of this one.
+      if (icf_relocs_changed(*info, *kept_section_id))
+        {
+          get_section_contents(false, id_section[i], symtab,
+                               (*kept_section_id), info);
+          hash_section_info(false, info);
         }
+
       // If there are no relocs to foldable sections do not process
       // this section any further.
-      if (iteration_num == 1 && (*num_tracked_relocs)[i] == 0)
+      if (first_iteration && info->tracked.empty())
         (*is_secn_or_group_unique)[i] = true;
+
+      key_range = section_hash.equal_range(info->hash);
+      Unordered_multimap<uint64_t, unsigned int>::iterator it;
+      // Search all the groups with this hash for a match.
+      for (it = key_range.first; it != key_range.second; ++it)
+        {
+          unsigned int kept_section = it->second;
+          const Icf_section_info& kept_info((*section_info)[kept_section]);
+          if (kept_info.contents != info->contents
+              || kept_info.icf_relocs != info->icf_relocs)
+            continue;
+          (*kept_section_id)[i] = kept_section;
+          converged = false;
+          break;
+        }
+      if (it == key_range.second)
+        {
+          // Create a new group for this hash.
+          section_hash.insert(std::make_pair(info->hash, i));
+        }
+      else
+        release_section_info(info);
     }
 
   return converged;
@@ -678,9 +811,7 @@ Icf::find_identical_sections(const Input_objects* input_objects,
                              Symbol_table* symtab)
 {
   unsigned int section_num = 0;
-  std::vector<unsigned int> num_tracked_relocs;
   std::vector<bool> is_secn_or_group_unique;
-  std::vector<std::string> section_contents;
   const Target& target = parameters->target();
 
   // Decide which sections are possible candidates first.
@@ -718,13 +849,13 @@ Icf::find_identical_sections(const Input_objects* input_objects,
           this->id_section_.push_back(Section_id(*p, i));
           this->section_id_[Section_id(*p, i)] = section_num;
           this->kept_section_id_.push_back(section_num);
-          num_tracked_relocs.push_back(0);
           is_secn_or_group_unique.push_back(false);
-          section_contents.push_back("");
           section_num++;
         }
     }
 
+  std::vector<Icf_section_info> section_info(section_num);
+
   unsigned int num_iterations = 0;
 
   // Default number of iterations to run ICF is 2.
@@ -738,9 +869,9 @@ Icf::find_identical_sections(const Input_objects* input_objects,
     {
       num_iterations++;
       converged = match_sections(num_iterations, symtab,
-                                 &num_tracked_relocs, &this->kept_section_id_,
+                                 &this->kept_section_id_,
                                  this->id_section_, &is_secn_or_group_unique,
-                                 &section_contents);
+                                 &section_info);
     }
 
   if (parameters->options().print_icf_sections())
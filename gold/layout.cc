@@ -50,6 +50,7 @@
 #include "descriptors.h"
 #include "plugin.h"
 #include "incremental.h"
+#include "workqueue.h"
 #include "layout.h"
 
 namespace gold
@@ -69,6 +70,12 @@ unsigned int Free_list::num_remove_visits = 0;
 unsigned int Free_list::num_allocates = 0;
 // The total number of nodes visited during calls to Free_list::allocate.
 unsigned int Free_list::num_allocate_visits = 0;
+// The number of free extents currently in all free lists.
+unsigned int Free_list::num_free_extents = 0;
+// The number of free bytes currently in all free lists.
+uint64_t Free_list::num_free_bytes = 0;
+// The number of allocations that had to extend the region.
+unsigned int Free_list::num_extends = 0;
 
 // Initialize the free list.  Creates a single free list node that
 // describes the entire region of length LEN.  If EXTEND is true,
@@ -78,22 +85,75 @@ unsigned int Free_list::num_allocate_visits = 0;
 void
 Free_list::init(off_t len, bool extend)
 {
-  this->list_.push_front(Free_list_node(0, len));
-  this->last_remove_ = this->list_.begin();
+  if (len > 0)
+    this->add_extent(0, len);
   this->extend_ = extend;
   this->length_ = len;
   ++Free_list::num_lists;
   ++Free_list::num_nodes;
 }
 
+// Add the free extent [START, END) to both indexes.
+
+void
+Free_list::add_extent(off_t start, off_t end)
+{
+  gold_assert(start < end);
+  this->extents_.insert(std::make_pair(start, end));
+  this->extents_by_length_.insert(std::make_pair(end - start, start));
+  ++Free_list::num_free_extents;
+  Free_list::num_free_bytes += end - start;
+}
+
+// Remove the free extent P from both indexes.
+
+void
+Free_list::remove_extent(Iterator p)
+{
+  off_t start = p->first;
+  off_t end = p->second;
+  this->extents_by_length_.erase(std::make_pair(end - start, start));
+  this->extents_.erase(p);
+  --Free_list::num_free_extents;
+  Free_list::num_free_bytes -= end - start;
+}
+
+// Take the chunk [START, END) out of the free extent P, which must
+// wholly contain it.  Add some fuzz to avoid creating tiny free
+// chunks.
+
+void
+Free_list::take(Iterator p, off_t start, off_t end)
+{
+  off_t pstart = p->first;
+  off_t pend = p->second;
+  gold_assert(pstart <= start && pend >= end);
+  this->remove_extent(p);
+
+  // Case 1: the indicated region spans the whole node.
+  if (pstart + 3 >= start && pend <= end + 3)
+    ;
+  // Case 2: remove a chunk from the start of the node.
+  else if (pstart + 3 >= start)
+    this->add_extent(end, pend);
+  // Case 3: remove a chunk from the end of the node.
+  else if (pend <= end + 3)
+    this->add_extent(pstart, start);
+  // Case 4: remove a chunk from the middle, and split
+  // the node into two.
+  else
+    {
+      this->add_extent(pstart, start);
+      this->add_extent(end, pend);
+      ++Free_list::num_nodes;
+    }
+}
+
 // Remove a chunk from the free list.  Because we start with a single
 // node that covers the entire section, and remove chunks from it one
 // at a time, we do not need to coalesce chunks or handle cases that
-// span more than one free node.  We expect to remove chunks from the
-// free list in order, and we expect to have only a few chunks of free
-// space left (corresponding to files that have changed since the last
-// incremental link), so a simple linear list should provide sufficient
-// performance.
+// span more than one free node.  The only node that can contain the
+// chunk is the last one starting at or before START.
 
 void
 Free_list::remove(off_t start, off_t end)
@@ -103,37 +163,16 @@ Free_list::remove(off_t start, off_t end)
   gold_assert(start < end);
 
   ++Free_list::num_removes;
+  ++Free_list::num_remove_visits;
 
-  Iterator p = this->last_remove_;
-  if (p->start_ > start)
-    p = this->list_.begin();
-
-  for (; p != this->list_.end(); ++p)
+  Iterator p = this->extents_.upper_bound(start);
+  if (p != this->extents_.begin())
     {
-      ++Free_list::num_remove_visits;
-      // Find a node that wholly contains the indicated region.
-      if (p->start_ <= start && p->end_ >= end)
+      --p;
+      // Check that the node wholly contains the indicated region.
+      if (p->second >= end)
 	{
-	  // Case 1: the indicated region spans the whole node.
-	  // Add some fuzz to avoid creating tiny free chunks.
-	  if (p->start_ + 3 >= start && p->end_ <= end + 3)
-	    p = this->list_.erase(p);
-	  // Case 2: remove a chunk from the start of the node.
-	  else if (p->start_ + 3 >= start)
-	    p->start_ = end;
-	  // Case 3: remove a chunk from the end of the node.
-	  else if (p->end_ <= end + 3)
-	    p->end_ = start;
-	  // Case 4: remove a chunk from the middle, and split
-	  // the node into two.
-	  else
-	    {
-	      Free_list_node newnode(p->start_, start);
-	      p->start_ = end;
-	      this->list_.insert(p, newnode);
-	      ++Free_list::num_nodes;
-	    }
-	  this->last_remove_ = p;
+	  this->take(p, start, end);
 	  return;
 	}
     }
@@ -147,7 +186,10 @@ Free_list::remove(off_t start, off_t end)
 
 // Allocate a chunk of size LEN from the free list.  Returns -1ULL
 // if a sufficiently large chunk of free space is not found.
-// We use a simple first-fit algorithm.
+// We use a best-fit algorithm: the free extents are visited from the
+// shortest one that is at least LEN bytes long upward, and the first
+// that can hold LEN bytes at the requested alignment is used.  Only
+// if none can do we extend the region.
 
 off_t
 Free_list::allocate(off_t len, uint64_t align, off_t minoff)
@@ -161,38 +203,50 @@ Free_list::allocate(off_t len, uint64_t align, off_t minoff)
 
   ++Free_list::num_allocates;
 
-  for (Iterator p = this->list_.begin(); p != this->list_.end(); ++p)
+  Extents_by_length::const_iterator q =
+    this->extents_by_length_.lower_bound(std::make_pair(len, off_t(0)));
+  for (; q != this->extents_by_length_.end(); ++q)
     {
       ++Free_list::num_allocate_visits;
-      off_t start = p->start_ > minoff ? p->start_ : minoff;
+      off_t pstart = q->second;
+      off_t pend = pstart + q->first;
+      off_t start = pstart > minoff ? pstart : minoff;
       start = align_address(start, align);
       off_t end = start + len;
-      if (end > p->end_ && p->end_ == this->length_ && this->extend_)
+      if (end <= pend)
 	{
-	  this->length_ = end;
-	  p->end_ = end;
-	}
-      if (end <= p->end_)
-	{
-	  if (p->start_ + 3 >= start && p->end_ <= end + 3)
-	    this->list_.erase(p);
-	  else if (p->start_ + 3 >= start)
-	    p->start_ = end;
-	  else if (p->end_ <= end + 3)
-	    p->end_ = start;
-	  else
-	    {
-	      Free_list_node newnode(p->start_, start);
-	      p->start_ = end;
-	      this->list_.insert(p, newnode);
-	      ++Free_list::num_nodes;
-	    }
+	  this->take(this->extents_.find(pstart), start, end);
 	  return start;
 	}
     }
+
   if (this->extend_)
     {
-      off_t start = align_address(this->length_, align);
+      ++Free_list::num_extends;
+
+      // If the last free extent runs to the end of the region, grow
+      // it so that the allocation can use its space.
+      if (!this->extents_.empty())
+	{
+	  Iterator p = this->extents_.end();
+	  --p;
+	  if (p->second == this->length_)
+	    {
+	      off_t pstart = p->first;
+	      off_t start = pstart > minoff ? pstart : minoff;
+	      start = align_address(start, align);
+	      off_t end = start + len;
+	      gold_assert(end > this->length_);
+	      this->length_ = end;
+	      this->remove_extent(p);
+	      this->add_extent(pstart, end);
+	      this->take(this->extents_.find(pstart), start, end);
+	      return start;
+	    }
+	}
+
+      off_t start = this->length_ > minoff ? this->length_ : minoff;
+      start = align_address(start, align);
       this->length_ = start + len;
       return start;
     }
@@ -204,10 +258,10 @@ void
 Free_list::dump()
 {
   gold_info("Free list:\n     start      end   length\n");
-  for (Iterator p = this->list_.begin(); p != this->list_.end(); ++p)
-    gold_info("  %08lx %08lx %08lx", static_cast<long>(p->start_),
-	      static_cast<long>(p->end_),
-	      static_cast<long>(p->end_ - p->start_));
+  for (Iterator p = this->extents_.begin(); p != this->extents_.end(); ++p)
+    gold_info("  %08lx %08lx %08lx", static_cast<long>(p->first),
+	      static_cast<long>(p->second),
+	      static_cast<long>(p->second - p->first));
 }
 
 // Print the statistics for the free lists.
@@ -226,6 +280,18 @@ Free_list::print_stats()
           program_name, Free_list::num_allocates);
   fprintf(stderr, _("%s: nodes visited: %u\n"),
           program_name, Free_list::num_allocate_visits);
+  fprintf(stderr, _("%s: allocations extending the region: %u\n"),
+          program_name, Free_list::num_extends);
+  fprintf(stderr, _("%s: free extents remaining: %u\n"),
+          program_name, Free_list::num_free_extents);
+  fprintf(stderr, _("%s: free bytes remaining: %llu\n"),
+          program_name,
+	  static_cast<unsigned long long>(Free_list::num_free_bytes));
+  if (Free_list::num_free_extents > 0)
+    fprintf(stderr, _("%s: average free extent length: %llu\n"),
+	    program_name,
+	    static_cast<unsigned long long>(Free_list::num_free_bytes
+					    / Free_list::num_free_extents));
 }
 
 // Layout::Relaxation_debug_check methods.
@@ -379,6 +445,7 @@ Layout::Layout(int number_of_input_files, Script_options* script_options)
     dynamic_section_(NULL),
     dynamic_symbol_(NULL),
     dynamic_data_(NULL),
+    relr_dyn_(NULL),
     eh_frame_section_(NULL),
     eh_frame_data_(NULL),
     added_eh_frame_data_(false),
@@ -2503,7 +2570,7 @@ Layout::create_build_id()
   std::string desc;
   if (strcmp(style, "md5") == 0)
     descsz = 128 / 8;
-  else if (strcmp(style, "sha1") == 0)
+  else if (strcmp(style, "sha1") == 0 || strcmp(style, "tree") == 0)
     descsz = 160 / 8;
   else if (strcmp(style, "uuid") == 0)
     {
@@ -3557,6 +3624,23 @@ Layout::create_dynamic_symtab(const Input_objects* input_objects,
   unsigned int local_symcount = index;
   *plocal_dynamic_count = local_symcount;
 
+  // The dynamic linker requires a reference to GLIBC_ABI_DT_RELR
+  // when it sees DT_RELR, so that older dynamic linkers refuse to
+  // load the output.  This must be recorded before the versions are
+  // finalized.
+  if (this->relr_dyn_ != NULL && this->relr_dyn_->current_data_size() > 0)
+    {
+      for (Input_objects::Dynobj_iterator p = input_objects->dynobj_begin();
+	   p != input_objects->dynobj_end();
+	   ++p)
+	{
+	  if (!(*p)->is_needed() && (*p)->as_needed())
+	    continue;
+	  if ((*p)->defines_relr_version())
+	    pversions->record_need(&this->dynpool_, *p, "GLIBC_ABI_DT_RELR");
+	}
+    }
+
   index = symtab->set_dynsym_indexes(index, pdynamic_symbols,
 				     &this->dynpool_, pversions);
 
@@ -3981,6 +4065,16 @@ Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
 	}
     }
 
+  if (this->relr_dyn_ != NULL
+      && this->relr_dyn_->output_section() != NULL
+      && this->relr_dyn_->current_data_size() > 0)
+    {
+      odyn->add_section_address(elfcpp::DT_RELR, this->relr_dyn_);
+      odyn->add_section_size(elfcpp::DT_RELRSZ, this->relr_dyn_);
+      odyn->add_constant(elfcpp::DT_RELRENT,
+			 parameters->target().get_size() / 8);
+    }
+
   if (add_debug && !parameters->options().shared())
     {
       // The value of the DT_DEBUG tag is filled in by the dynamic
@@ -3989,6 +4083,18 @@ Layout::add_target_dynamic_tags(bool use_rel, const Output_data* plt_got,
     }
 }
 
+// Add the section holding packed relative relocs.
+
+void
+Layout::add_relr_dyn_section(Output_section_data* relr_dyn)
+{
+  gold_assert(this->relr_dyn_ == NULL);
+  this->relr_dyn_ = relr_dyn;
+  this->add_output_section_data(".relr.dyn", elfcpp::SHT_RELR,
+				elfcpp::SHF_ALLOC, relr_dyn,
+				ORDER_DYNAMIC_RELOCS, false);
+}
+
 // Finish the .dynamic section and PT_DYNAMIC segment.
 
 void
@@ -4529,9 +4635,56 @@ Layout::write_sections_after_input_sections(Output_file* of)
   this->section_headers_->write(of);
 }
 
+// The size of the chunks hashed separately by --build-id=tree.  This
+// is fixed so that the build ID does not depend on the number of
+// threads.
+
+static const off_t build_id_tree_chunk_size = 1024 * 1024;
+
+// A Parallel_runner used by Layout::write_build_id for
+// --build-id=tree.  Part I of this computes the SHA-1 of the Ith range
+// of chunks of the file, storing them in DIGESTS.
+
+class Build_id_tree_hasher : public Parallel_runner
+{
+ public:
+  Build_id_tree_hasher(const unsigned char* iv, off_t file_size,
+		       unsigned char* digests, size_t chunks,
+		       unsigned int parts)
+    : iv_(iv), file_size_(file_size), digests_(digests), chunks_(chunks),
+      parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t begin = this->chunks_ / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? this->chunks_
+		  : this->chunks_ / this->parts_ * (part + 1));
+    for (size_t i = begin; i < end; ++i)
+      {
+	off_t start = i * build_id_tree_chunk_size;
+	off_t len = std::min(build_id_tree_chunk_size,
+			     this->file_size_ - start);
+	sha1_buffer(reinterpret_cast<const char*>(this->iv_ + start), len,
+		    this->digests_ + i * (160 / 8));
+      }
+  }
+
+ private:
+  const unsigned char* iv_;
+  off_t file_size_;
+  unsigned char* digests_;
+  size_t chunks_;
+  unsigned int parts_;
+};
+
 // If the build ID requires computing a checksum, do so here, and
 // write it out.  We compute a checksum over the entire file because
-// that is simplest.
+// that is simplest.  For --build-id=tree, we compute the SHA-1 of each
+// chunk of the file on all the threads, and the build ID is the SHA-1
+// of those.
 
 void
 Layout::write_build_id(Output_file* of) const
@@ -4559,6 +4712,21 @@ Layout::write_build_id(Output_file* of) const
       md5_process_bytes(iv, this->output_file_size_, &ctx);
       md5_finish_ctx(&ctx, ov);
     }
+  else if (strcmp(style, "tree") == 0)
+    {
+      size_t chunks = ((this->output_file_size_ + build_id_tree_chunk_size
+			- 1)
+		       / build_id_tree_chunk_size);
+      std::vector<unsigned char> digests(chunks * (160 / 8));
+      unsigned int parts = std::max(1U,
+				    std::min(Workqueue::parallel_thread_count(),
+					     static_cast<unsigned int>(chunks)));
+      Build_id_tree_hasher hasher(iv, this->output_file_size_,
+				  &digests[0], chunks, parts);
+      Workqueue::run_in_parallel(&hasher, parts);
+      sha1_buffer(reinterpret_cast<const char*>(&digests[0]), digests.size(),
+		  ov);
+    }
   else
     gold_unreachable();
 
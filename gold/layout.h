@@ -26,6 +26,7 @@
 #include <cstring>
 #include <list>
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -66,13 +67,16 @@ extern bool
 is_compressed_debug_section(const char* secname);
 
 // Maintain a list of free space within a section, segment, or file.
-// Used for incremental update links.
+// Used for incremental update links.  The free extents are indexed
+// both by address and by length, so that removing a chunk and finding
+// the best fit for an allocation take logarithmic time no matter how
+// fragmented the region has become.
 
 class Free_list
 {
  public:
   Free_list()
-    : list_(), last_remove_(list_.begin()), extend_(false), length_(0)
+    : extents_(), extents_by_length_(), extend_(false), length_(0)
   { }
 
   void
@@ -91,21 +95,29 @@ class Free_list
   print_stats();
 
  private:
-  struct Free_list_node
-  {
-    Free_list_node(off_t start, off_t end)
-      : start_(start), end_(end)
-    { }
-    off_t start_;
-    off_t end_;
-  };
-  typedef std::list<Free_list_node>::iterator Iterator;
+  // The free extents, mapping the start of each extent to its end.
+  typedef std::map<off_t, off_t> Extents;
+  typedef Extents::iterator Iterator;
+  // The free extents, ordered by length and then by start.
+  typedef std::set<std::pair<off_t, off_t> > Extents_by_length;
 
-  // The free list.
-  std::list<Free_list_node> list_;
+  // Add the free extent [START, END).
+  void
+  add_extent(off_t start, off_t end);
 
-  // The last node visited during a remove operation.
-  Iterator last_remove_;
+  // Remove the free extent P.
+  void
+  remove_extent(Iterator p);
+
+  // Take the chunk [START, END) out of the free extent P.
+  void
+  take(Iterator p, off_t start, off_t end);
+
+  // The free extents, indexed by address.
+  Extents extents_;
+
+  // The free extents, indexed by length.
+  Extents_by_length extents_by_length_;
 
   // Whether we can extend past the original length.
   bool extend_;
@@ -126,6 +138,12 @@ class Free_list
   static unsigned int num_allocates;
   // The total number of nodes visited during calls to Free_list::allocate.
   static unsigned int num_allocate_visits;
+  // The number of free extents currently in all free lists.
+  static unsigned int num_free_extents;
+  // The number of free bytes currently in all free lists.
+  static uint64_t num_free_bytes;
+  // The number of allocations that had to extend the region.
+  static unsigned int num_extends;
 };
 
 // This task function handles mapping the input sections to output
@@ -773,6 +791,11 @@ class Layout
 			  const Output_data_reloc_generic* dyn_rel,
 			  bool add_debug, bool dynrel_includes_plt);
 
+  // For the target-specific code to add the section holding packed
+  // relative relocs, for -z pack-relative-relocs.
+  void
+  add_relr_dyn_section(Output_section_data* relr_dyn);
+
   // Compute and write out the build ID if needed.
   void
   write_build_id(Output_file*) const;
@@ -1195,6 +1218,8 @@ class Layout
   Symbol* dynamic_symbol_;
   // The dynamic data which goes into dynamic_section_.
   Output_data_dynamic* dynamic_data_;
+  // The packed relative relocs if there are any.
+  Output_section_data* relr_dyn_;
   // The exception frame output section if there is one.
   Output_section* eh_frame_section_;
   // The exception frame data for eh_frame_section_.
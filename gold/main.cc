@@ -262,6 +262,7 @@ main(int argc, char** argv)
       fprintf(stderr, _("%s: total space allocated by malloc: %d bytes\n"),
 	      program_name, m.arena);
 #endif
+      workqueue.print_stats();
       File_read::print_stats();
       Archive::print_stats();
       Lib_group::print_stats();
@@ -269,6 +270,7 @@ main(int argc, char** argv)
 	      program_name, static_cast<long long>(layout.output_file_size()));
       symtab.print_stats();
       layout.print_stats();
+      input_objects.print_stats();
       Free_list::print_stats();
     }
 
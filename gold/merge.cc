@@ -27,6 +27,7 @@
 
 #include "merge.h"
 #include "compressed_output.h"
+#include "workqueue.h"
 
 namespace gold
 {
@@ -139,6 +140,21 @@ Object_merge_map::add_mapping(const Merge_map* merge_map, unsigned int shndx,
   map->entries.push_back(entry);
 }
 
+// Sort the mappings for every input section.
+
+void
+Object_merge_map::sort_mappings()
+{
+  if (this->first_shnum_ != -1U)
+    this->first_map_.sort();
+  if (this->second_shnum_ != -1U)
+    this->second_map_.sort();
+  for (Section_merge_maps::iterator p = this->section_merge_maps_.begin();
+       p != this->section_merge_maps_.end();
+       ++p)
+    p->second->sort();
+}
+
 // Get the output offset for an input address.
 
 bool
@@ -152,12 +168,7 @@ Object_merge_map::get_output_offset(const Merge_map* merge_map,
       || (merge_map != NULL && map->merge_map != merge_map))
     return false;
 
-  if (!map->sorted)
-    {
-      std::sort(map->entries.begin(), map->entries.end(),
-		Input_merge_compare());
-      map->sorted = true;
-    }
+  map->sort();
 
   Input_merge_entry entry;
   entry.input_offset = input_offset;
@@ -508,6 +519,95 @@ Output_merge_data::do_print_merge_stats(const char* section_name)
 
 // Class Output_merge_string.
 
+// Class Output_merge_string::String_hasher.  Part I of this computes
+// the hash codes of the Ith range of the strings found in an input
+// section.
+
+template<typename Char_type>
+class Output_merge_string<Char_type>::String_hasher : public Parallel_runner
+{
+ public:
+  String_hasher(const unsigned char* pdata,
+		const Merged_strings& merged_strings,
+		std::vector<size_t>* hash_codes, unsigned int parts)
+    : pdata_(pdata), merged_strings_(merged_strings),
+      hash_codes_(hash_codes), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t count = this->hash_codes_->size();
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? count
+		  : count / this->parts_ * (part + 1));
+    for (size_t i = begin; i < end; ++i)
+      {
+	section_offset_type offset = this->merged_strings_[i].offset;
+	const Char_type* s =
+	  reinterpret_cast<const Char_type*>(this->pdata_ + offset);
+	size_t len = ((this->merged_strings_[i + 1].offset - offset)
+		      / sizeof(Char_type) - 1);
+	(*this->hash_codes_)[i] = string_hash<Char_type>(s, len);
+      }
+  }
+
+ private:
+  const unsigned char* pdata_;
+  const Merged_strings& merged_strings_;
+  std::vector<size_t>* hash_codes_;
+  unsigned int parts_;
+};
+
+// Class Output_merge_string::Mapping_adder.  Part I of this adds the
+// mappings for each list of merged strings whose entry in LIST_PARTS
+// is I, and then frees the list.
+
+template<typename Char_type>
+class Output_merge_string<Char_type>::Mapping_adder : public Parallel_runner
+{
+ public:
+  Mapping_adder(Output_merge_string* output,
+		const std::vector<unsigned int>& list_parts)
+    : output_(output), list_parts_(list_parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    const Merged_strings_lists& lists(this->output_->merged_strings_lists_);
+    for (size_t i = 0; i < lists.size(); ++i)
+      {
+	if (this->list_parts_[i] != part)
+	  continue;
+	Merged_strings_list* l = lists[i];
+	section_offset_type last_input_offset = 0;
+	section_offset_type last_output_offset = 0;
+	for (typename Merged_strings::const_iterator p =
+	       l->merged_strings.begin();
+	     p != l->merged_strings.end();
+	     ++p)
+	  {
+	    section_size_type length = p->offset - last_input_offset;
+	    if (length > 0)
+	      this->output_->add_mapping(l->object, l->shndx,
+					 last_input_offset, length,
+					 last_output_offset);
+	    last_input_offset = p->offset;
+	    if (p->stringpool_key != 0)
+	      last_output_offset =
+		this->output_->stringpool_.get_offset_from_key(p->stringpool_key);
+	  }
+	delete l;
+      }
+  }
+
+ private:
+  Output_merge_string* output_;
+  const std::vector<unsigned int>& list_parts_;
+};
+
 // Add an input section to a merged string section.
 
 template<typename Char_type>
@@ -568,29 +668,19 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
     ++count;
   merged_strings.reserve(count + 1);
 
-  // The index I is in bytes, not characters.
+  // Find the strings.  The index I is in bytes, not characters.
   section_size_type i = 0;
   while (p < pend0)
     {
       size_t len = string_length(p);
-
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
-
-      merged_strings.push_back(Merged_string(i, key));
-
+      merged_strings.push_back(Merged_string(i, 0));
       p += len + 1;
       i += (len + 1) * sizeof(Char_type);
     }
   if (p < pend)
     {
       size_t len = pend - p;
-
-      Stringpool::Key key;
-      this->stringpool_.add_with_length(p, len, true, &key);
-
-      merged_strings.push_back(Merged_string(i, key));
-
+      merged_strings.push_back(Merged_string(i, 0));
       i += (len + 1) * sizeof(Char_type);
     }
 
@@ -598,6 +688,28 @@ Output_merge_string<Char_type>::do_add_input_section(Relobj* object,
   // compute the length of the last string.
   merged_strings.push_back(Merged_string(i, 0));
 
+  // Hashing the strings is the expensive part, so do that on all the
+  // threads.  The strings are then added to the Stringpool in order,
+  // so that the output does not depend on the number of threads.
+  std::vector<size_t> hash_codes(count);
+  unsigned int parts = std::max(1U,
+				std::min(Workqueue::parallel_thread_count(),
+					 static_cast<unsigned int>(count
+								   / 4096)));
+  String_hasher hasher(pdata, merged_strings, &hash_codes, parts);
+  Workqueue::run_in_parallel(&hasher, parts);
+
+  for (size_t j = 0; j < count; ++j)
+    {
+      Merged_string& ms(merged_strings[j]);
+      const Char_type* s = reinterpret_cast<const Char_type*>(pdata
+							      + ms.offset);
+      size_t len = ((merged_strings[j + 1].offset - ms.offset)
+		    / sizeof(Char_type) - 1);
+      this->stringpool_.add_with_hash(s, len, hash_codes[j], true,
+				      &ms.stringpool_key);
+    }
+
   this->input_count_ += count;
   this->input_size_ += len;
 
@@ -620,30 +732,35 @@ Output_merge_string<Char_type>::finalize_merged_data()
 {
   this->stringpool_.set_string_offsets();
 
-  for (typename Merged_strings_lists::const_iterator l =
-	 this->merged_strings_lists_.begin();
-       l != this->merged_strings_lists_.end();
-       ++l)
+  // Each Object_merge_map is only touched by one part, so the
+  // mappings for different objects may be added at the same time.
+  // Within an object the mappings are added in the order of the
+  // input sections, as before.
+  size_t count = this->merged_strings_lists_.size();
+  unsigned int parts = std::max(1U,
+				std::min(Workqueue::parallel_thread_count(),
+					 static_cast<unsigned int>(count / 64)));
+  std::vector<unsigned int> list_parts(count);
+  if (parts > 1)
     {
-      section_offset_type last_input_offset = 0;
-      section_offset_type last_output_offset = 0;
-      for (typename Merged_strings::const_iterator p =
-	     (*l)->merged_strings.begin();
-	   p != (*l)->merged_strings.end();
-	   ++p)
+      Unordered_map<const Relobj*, unsigned int> object_parts;
+      unsigned int next_part = 0;
+      for (size_t i = 0; i < count; ++i)
 	{
-	  section_size_type length = p->offset - last_input_offset;
-	  if (length > 0)
-	    this->add_mapping((*l)->object, (*l)->shndx, last_input_offset,
-	    		      length, last_output_offset);
-	  last_input_offset = p->offset;
-	  if (p->stringpool_key != 0)
-	    last_output_offset =
-	        this->stringpool_.get_offset_from_key(p->stringpool_key);
+	  const Relobj* object = this->merged_strings_lists_[i]->object;
+	  std::pair<typename Unordered_map<const Relobj*,
+					   unsigned int>::iterator,
+		    bool> ins =
+	    object_parts.insert(std::make_pair(object, next_part));
+	  if (ins.second)
+	    next_part = (next_part + 1) % parts;
+	  list_parts[i] = ins.first->second;
 	}
-      delete *l;
     }
 
+  Mapping_adder adder(this, list_parts);
+  Workqueue::run_in_parallel(&adder, parts);
+
   // Save some memory.  This also ensures that this function will work
   // if called twice, as may happen if Layout::set_segment_offsets
   // finds a better alignment.
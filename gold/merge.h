@@ -23,6 +23,7 @@
 #ifndef GOLD_MERGE_H
 #define GOLD_MERGE_H
 
+#include <algorithm>
 #include <climits>
 #include <map>
 #include <vector>
@@ -76,6 +77,12 @@ class Object_merge_map
   bool
   is_merge_section_for(const Merge_map*, unsigned int shndx);
 
+  // Sort the mappings for every input section.  get_output_offset
+  // sorts them itself when needed, so call this before looking up
+  // offsets on several threads at once.
+  void
+  sort_mappings();
+
   // Initialize an mapping from input offsets to output addresses for
   // section SHNDX.  STARTING_ADDRESS is the output address of the
   // merged section.
@@ -142,6 +149,18 @@ class Object_merge_map
     Input_merge_map()
       : merge_map(NULL), entries(), sorted(true)
     { }
+
+    // Sort ENTRIES by input_offset if needed.
+    void
+    sort()
+    {
+      if (!this->sorted)
+	{
+	  std::sort(this->entries.begin(), this->entries.end(),
+		    Input_merge_compare());
+	  this->sorted = true;
+	}
+    }
   };
 
   // Map input section indices to merge maps.
@@ -559,6 +578,14 @@ class Output_merge_string : public Output_merge_base
 
   typedef std::vector<Merged_strings_list*> Merged_strings_lists;
 
+  // A Parallel_runner used by do_add_input_section to hash the
+  // strings in an input section.
+  class String_hasher;
+
+  // A Parallel_runner used by finalize_merged_data to add the
+  // mappings for the input sections.
+  class Mapping_adder;
+
   // As we see the strings, we add them to a Stringpool.
   Stringpool_template<Char_type> stringpool_;
   // Map from a location in an input object to an entry in the
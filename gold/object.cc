@@ -59,6 +59,8 @@ Read_symbols_data::~Read_symbols_data()
     delete this->symbols;
   if (this->symbol_names != NULL)
     delete this->symbol_names;
+  if (this->symbol_name_info != NULL)
+    delete[] this->symbol_name_info;
   if (this->versym != NULL)
     delete this->versym;
   if (this->verdef != NULL)
@@ -67,6 +69,86 @@ Read_symbols_data::~Read_symbols_data()
     delete this->verneed;
 }
 
+// Class Object_arena.
+
+// The sizes of normal arena blocks.  Most objects need very little
+// metadata, so the first block is small, and each later one is as
+// large as all the earlier ones together, up to the maximum.  Requests
+// for more than a quarter of the current block size get a block of
+// their own.
+
+static const size_t object_arena_min_block_size = 512;
+static const size_t object_arena_max_block_size = 8192;
+
+// Free all the blocks.
+
+Object_arena::~Object_arena()
+{
+  Block_header* p = this->blocks_;
+  while (p != NULL)
+    {
+      Block_header* next = p->next;
+      delete[] reinterpret_cast<unsigned char*>(p);
+      p = next;
+    }
+}
+
+// Allocate SIZE bytes.  A request for zero bytes still gets a unique
+// non-NULL pointer, since callers check the result against NULL.
+
+void*
+Object_arena::allocate(size_t size)
+{
+  const size_t align = sizeof(Block_header);
+  if (size == 0)
+    size = align;
+  size = (size + align - 1) & ~(align - 1);
+  this->allocated_bytes_ += size;
+
+  if (size > static_cast<size_t>(this->end_ - this->next_))
+    return this->allocate_block(size);
+
+  void* ret = this->next_;
+  this->next_ += size;
+  return ret;
+}
+
+// Allocate a new block with room for at least SIZE bytes, and return
+// the first SIZE bytes of it.
+
+void*
+Object_arena::allocate_block(size_t size)
+{
+  size_t data_size = this->block_bytes_;
+  if (data_size < object_arena_min_block_size)
+    data_size = object_arena_min_block_size;
+  else if (data_size > object_arena_max_block_size)
+    data_size = object_arena_max_block_size;
+  bool is_large = size > data_size / 4;
+  if (is_large)
+    data_size = size;
+  size_t block_size = sizeof(Block_header) + data_size;
+  unsigned char* block = new unsigned char[block_size];
+  this->block_bytes_ += block_size;
+
+  Block_header* header = reinterpret_cast<Block_header*>(block);
+  unsigned char* data = block + sizeof(Block_header);
+  if (is_large && this->blocks_ != NULL)
+    {
+      // Keep allocating from the current block; put the large block
+      // after it in the list.
+      header->next = this->blocks_->next;
+      this->blocks_->next = header;
+      return data;
+    }
+
+  header->next = this->blocks_;
+  this->blocks_ = header;
+  this->next_ = data + size;
+  this->end_ = data + data_size;
+  return data;
+}
+
 // Class Xindex.
 
 // Initialize the symtab_xindex_ array.  Find the SHT_SYMTAB_SHNDX
@@ -356,7 +438,7 @@ void
 Relobj::finalize_incremental_relocs(Layout* layout, bool clear_counts)
 {
   unsigned int nsyms = this->get_global_symbols()->size();
-  this->reloc_bases_ = new unsigned int[nsyms];
+  this->reloc_bases_ = this->arena_.allocate_array<unsigned int>(nsyms);
 
   gold_assert(this->reloc_bases_ != NULL);
   gold_assert(layout->incremental_inputs() != NULL);
@@ -604,6 +686,9 @@ Sized_relobj_file<size, big_endian>::do_read_symbols(Read_symbols_data* sd)
 
   this->find_symtab(pshdrs);
 
+  if (parameters->options().readahead())
+    this->readahead_sections(pshdrs);
+
   const unsigned char* namesu = sd->section_names->data();
   const char* names = reinterpret_cast<const char*>(namesu);
   if (memmem(names, sd->section_names_size, ".eh_frame", 10) != NULL)
@@ -621,6 +706,7 @@ Sized_relobj_file<size, big_endian>::do_read_symbols(Read_symbols_data* sd)
   sd->external_symbols_offset = 0;
   sd->symbol_names = NULL;
   sd->symbol_names_size = 0;
+  sd->symbol_name_info = NULL;
 
   if (this->symtab_shndx_ == 0)
     {
@@ -688,6 +774,70 @@ Sized_relobj_file<size, big_endian>::do_read_symbols(Read_symbols_data* sd)
   sd->symbol_names = fvstrtab;
   sd->symbol_names_size =
     convert_to_section_size_type(strtabshdr.get_sh_size());
+
+  // We are probably running in parallel with the other input files,
+  // so take this chance to parse and hash the external symbol names.
+  // Adding the symbols to the symbol table is done serially.
+  const unsigned char* psyms = fvsymtab->data() + sd->external_symbols_offset;
+  const char* sym_names = reinterpret_cast<const char*>(fvstrtab->data());
+  size_t symcount = extsize / sym_size;
+  Symbol_name_info* name_info = new Symbol_name_info[symcount];
+  for (size_t i = 0; i < symcount; ++i, psyms += sym_size)
+    {
+      elfcpp::Sym<size, big_endian> sym(psyms);
+      unsigned int st_name = sym.get_st_name();
+      if (st_name >= sd->symbol_names_size)
+	{
+	  // add_from_relobj will report the error.
+	  memset(&name_info[i], 0, sizeof name_info[i]);
+	  continue;
+	}
+      Symbol_table::get_symbol_name_info(sym_names + st_name, &name_info[i]);
+    }
+  sd->symbol_name_info = name_info;
+}
+
+// Start reading the sections which later passes will need in the
+// background: the symbol table and its names, which are read next, the
+// relocations, which are read when scanning relocations, and the
+// contents of the allocated sections, which are read when relocating.
+// This lets the system read them while we are busy with the input
+// files before this one.
+
+template<int size, bool big_endian>
+void
+Sized_relobj_file<size, big_endian>::readahead_sections(
+    const unsigned char* pshdrs)
+{
+  const unsigned int shnum = this->shnum();
+
+  unsigned int strtab_shndx = 0;
+  if (this->symtab_shndx_ != 0)
+    {
+      typename This::Shdr symtabshdr(pshdrs
+				     + this->symtab_shndx_ * This::shdr_size);
+      strtab_shndx = this->adjust_shndx(symtabshdr.get_sh_link());
+    }
+
+  File_read::Readahead ra;
+  const unsigned char* p = pshdrs + This::shdr_size;
+  for (unsigned int i = 1; i < shnum; ++i, p += This::shdr_size)
+    {
+      typename This::Shdr shdr(p);
+      unsigned int sh_type = shdr.get_sh_type();
+      bool wanted = (i == this->symtab_shndx_
+		     || i == strtab_shndx
+		     || sh_type == elfcpp::SHT_REL
+		     || sh_type == elfcpp::SHT_RELA
+		     || ((shdr.get_sh_flags() & elfcpp::SHF_ALLOC) != 0
+			 && sh_type != elfcpp::SHT_NOBITS));
+
+      if (wanted && shdr.get_sh_size() > 0)
+	ra.push_back(File_read::Readahead_entry(
+	    shdr.get_sh_offset(),
+	    convert_to_section_size_type(shdr.get_sh_size())));
+    }
+  this->readahead(&ra);
 }
 
 // Return the section index of symbol SYM.  Set *VALUE to its value in
@@ -1666,6 +1816,7 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
 			  sd->symbols->data() + sd->external_symbols_offset,
 			  symcount, this->local_symbol_count_,
 			  sym_names, sd->symbol_names_size,
+			  sd->symbol_name_info,
 			  &this->symbols_,
 			  &this->defined_count_);
 
@@ -1673,6 +1824,8 @@ Sized_relobj_file<size, big_endian>::do_add_symbols(Symbol_table* symtab,
   sd->symbols = NULL;
   delete sd->symbol_names;
   sd->symbol_names = NULL;
+  delete[] sd->symbol_name_info;
+  sd->symbol_name_info = NULL;
 }
 
 // Find out if this object, that is a member of a lib group, should be included
@@ -2628,6 +2781,26 @@ Input_objects::print_symbol_counts(const Symbol_table* symtab) const
     this->cref_->print_symbol_counts(symtab);
 }
 
+// Print statistical information to stderr.  This is used for --stats.
+
+void
+Input_objects::print_stats() const
+{
+  size_t allocated_bytes = 0;
+  size_t block_bytes = 0;
+  for (Relobj_iterator p = this->relobj_begin();
+       p != this->relobj_end();
+       ++p)
+    {
+      allocated_bytes += (*p)->arena()->allocated_bytes();
+      block_bytes += (*p)->arena()->block_bytes();
+    }
+  fprintf(stderr, _("%s: object metadata arena bytes allocated: %zu\n"),
+	  program_name, allocated_bytes);
+  fprintf(stderr, _("%s: object metadata arena block bytes: %zu\n"),
+	  program_name, block_bytes);
+}
+
 // Print a cross reference table.
 
 void
@@ -2650,7 +2823,8 @@ Relocate_info<size, big_endian>::location(size_t, off_t offset) const
   std::string filename;
   std::string file_and_lineno;   // Better than filename-only, if available.
 
-  Sized_dwarf_line_info<size, big_endian> line_info(this->object);
+  Sized_dwarf_line_info<size, big_endian> line_info(this->object,
+						    this->data_shndx);
   // This will be "" if we failed to parse the debug info for any reason.
   file_and_lineno = line_info.addr2line(this->data_shndx, offset, NULL);
 
@@ -25,6 +25,7 @@
 
 #include <string>
 #include <vector>
+#include <new>
 
 #include "elfcpp.h"
 #include "elfcpp_file.h"
@@ -52,13 +53,32 @@ class Symbols_data;
 template<typename Stringpool_char>
 class Stringpool_template;
 
+// Information about the name of a global symbol in a relocatable
+// object.  Objects are read in parallel, but their symbols are added
+// to the symbol table one object at a time, in order.  So
+// read_symbols() does the work which depends only on the name.
+
+struct Symbol_name_info
+{
+  // The hash code of the name, not including any version.
+  size_t hash_code;
+  // The length of the name, not including any version.
+  unsigned int name_length;
+  // The offset of the version in the name, after the '@' or "@@".
+  // This is zero if there is no version.
+  unsigned int version_offset;
+  // Whether the version is the default version ("@@").
+  bool is_default_version;
+};
+
 // Data to pass from read_symbols() to add_symbols().
 
 struct Read_symbols_data
 {
   Read_symbols_data()
     : section_headers(NULL), section_names(NULL), symbols(NULL),
-      symbol_names(NULL), versym(NULL), verdef(NULL), verneed(NULL)
+      symbol_names(NULL), symbol_name_info(NULL), versym(NULL),
+      verdef(NULL), verneed(NULL)
   { }
 
   ~Read_symbols_data();
@@ -81,6 +101,9 @@ struct Read_symbols_data
   File_view* symbol_names;
   // Size of symbol name data in bytes.
   section_size_type symbol_names_size;
+  // Information about the names of the external symbols, or NULL.
+  // This is only used on relocatable objects.
+  Symbol_name_info* symbol_name_info;
 
   // Version information.  This is only used on dynamic objects.
   // Version symbol data (from SHT_GNU_versym section).
@@ -203,6 +226,73 @@ class Xindex
   Symtab_xindex symtab_xindex_;
 };
 
+// A simple bump allocator for metadata which lives as long as the
+// object which owns it.  Memory is handed out from large blocks, and
+// is only released, all at once, when the arena is destroyed.  The
+// destructors of objects built in the arena are never run.  An arena
+// is not thread-safe; each one is only used by the task which is
+// working on its object.
+
+class Object_arena
+{
+ public:
+  Object_arena()
+    : blocks_(NULL), next_(NULL), end_(NULL), allocated_bytes_(0),
+      block_bytes_(0)
+  { }
+
+  ~Object_arena();
+
+  // Return SIZE bytes of uninitialized memory, aligned for any type
+  // we put in an arena.
+  void*
+  allocate(size_t size);
+
+  // Return an uninitialized array of COUNT objects of type T.
+  template<typename T>
+  T*
+  allocate_array(size_t count)
+  { return static_cast<T*>(this->allocate(count * sizeof(T))); }
+
+  // The number of bytes handed out.
+  size_t
+  allocated_bytes() const
+  { return this->allocated_bytes_; }
+
+  // The number of bytes in the blocks, including overhead.
+  size_t
+  block_bytes() const
+  { return this->block_bytes_; }
+
+ private:
+  Object_arena(const Object_arena&);
+  Object_arena& operator=(const Object_arena&);
+
+  // Each block starts with a pointer to the previous block.  The
+  // union keeps the data which follows suitably aligned.
+  union Block_header
+  {
+    Block_header* next;
+    uint64_t align_int;
+    double align_double;
+  };
+
+  // Allocate a new block holding at least SIZE bytes.
+  void*
+  allocate_block(size_t size);
+
+  // The list of blocks, most recent first.
+  Block_header* blocks_;
+  // The next free byte in the current block.
+  unsigned char* next_;
+  // The end of the current block.
+  unsigned char* end_;
+  // The number of bytes handed out.
+  size_t allocated_bytes_;
+  // The total size of the blocks.
+  size_t block_bytes_;
+};
+
 // A GOT offset list.  A symbol may have more than one GOT offset
 // (e.g., when mixing modules compiled with two different TLS models),
 // but will usually have at most one.  GOT_TYPE identifies the type of
@@ -664,6 +754,11 @@ class Object
   read_multiple(const File_read::Read_multiple& rm)
   { this->input_file()->file().read_multiple(this->offset_, rm); }
 
+  // Start reading pieces of the underlying file in the background.
+  void
+  readahead(File_read::Readahead* ra)
+  { this->input_file()->file().readahead(this->offset_, ra); }
+
   // Stop caching views in the underlying file.
   void
   clear_view_cache_marks()
@@ -956,9 +1051,16 @@ class Relobj : public Object
       reloc_counts_(NULL),
       reloc_bases_(NULL),
       first_dyn_reloc_(0),
-      dyn_reloc_count_(0)
+      dyn_reloc_count_(0),
+      arena_()
   { }
 
+  // Return the arena used for metadata which lives as long as this
+  // object.
+  Object_arena*
+  arena()
+  { return &this->arena_; }
+
   // During garbage collection, the Read_symbols_data pass for 
   // each object is stored as layout needs to be done after 
   // reloc processing.
@@ -1250,7 +1352,7 @@ class Relobj : public Object
   allocate_incremental_reloc_counts()
   {
     unsigned int nsyms = this->do_get_global_symbols()->size();
-    this->reloc_counts_ = new unsigned int[nsyms];
+    this->reloc_counts_ = this->arena_.allocate_array<unsigned int>(nsyms);
     gold_assert(this->reloc_counts_ != NULL);
     memset(this->reloc_counts_, 0, nsyms * sizeof(unsigned int));
   }
@@ -1312,6 +1414,8 @@ class Relobj : public Object
   unsigned int first_dyn_reloc_;
   // Count of dynamic relocations for this object.
   unsigned int dyn_reloc_count_;
+  // Metadata about this object which is never freed separately.
+  Object_arena arena_;
 };
 
 // This class is used to handle relocations against a section symbol
@@ -1809,7 +1913,8 @@ class Sized_relobj : public Relobj
       p->second->set_offset(got_type, got_offset);
     else
       {
-        Got_offset_list* g = new Got_offset_list(got_type, got_offset);
+        void* mem = this->arena()->allocate(sizeof(Got_offset_list));
+        Got_offset_list* g = new (mem) Got_offset_list(got_type, got_offset);
         std::pair<Local_got_offsets::iterator, bool> ins =
             this->local_got_offsets_.insert(std::make_pair(symndx, g));
         gold_assert(ins.second);
@@ -2285,6 +2390,11 @@ class Sized_relobj_file : public Sized_relobj<size, big_endian>
   void
   find_symtab(const unsigned char* pshdrs);
 
+  // Start reading the sections which later passes will need in the
+  // background, given the section headers.
+  void
+  readahead_sections(const unsigned char* pshdrs);
+
   // Return whether SHDR has the right flags for a GNU style exception
   // frame section.
   bool
@@ -2585,6 +2695,11 @@ class Input_objects
   void
   print_symbol_counts(const Symbol_table*) const;
 
+  // Print statistical information to stderr.  This is used for
+  // --stats.
+  void
+  print_stats() const;
+
   // Print a cross reference table.
   void
   print_cref(const Symbol_table*, FILE*) const;
@@ -1204,10 +1204,21 @@ General_options::finalize()
 		 "[0.0, 1.0)"),
 	       this->hash_bucket_empty_fraction());
 
+  if (this->user_set_compress_debug_level()
+      && (this->compress_debug_level() < 0
+	  || this->compress_debug_level() > 9))
+    gold_fatal(_("--compress-debug-level value %d out of range [0, 9]"),
+	       this->compress_debug_level());
+
   if (this->implicit_incremental_ && this->incremental_mode_ == INCREMENTAL_OFF)
     gold_fatal(_("Options --incremental-changed, --incremental-unchanged, "
                  "--incremental-unknown require the use of --incremental"));
 
+  if (this->pack_relative_relocs()
+      && this->incremental_mode_ != INCREMENTAL_OFF)
+    gold_fatal(_("-z pack-relative-relocs is not compatible with "
+		 "incremental linking"));
+
   // FIXME: we can/should be doing a lot more sanity checking here.
 }
 
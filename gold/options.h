@@ -618,6 +618,10 @@ class General_options
               N_("Allow unresolved references in shared libraries"),
               N_("Do not allow unresolved references in shared libraries"));
 
+  DEFINE_string(archive_index_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Cache the symbol tables of archives in DIRECTORY"),
+		N_("DIRECTORY"));
+
   DEFINE_bool(as_needed, options::TWO_DASHES, '\0', false,
               N_("Only set DT_NEEDED for shared libraries if used"),
               N_("Always DT_NEEDED for shared libraries"));
@@ -646,13 +650,19 @@ class General_options
 	      N_("Bind defined function symbols locally"), NULL);
 
   DEFINE_optional_string(build_id, options::TWO_DASHES, '\0', "sha1",
-			 N_("Generate build ID note"),
+			 N_("Generate build ID note; STYLE is md5, sha1, "
+			    "tree, uuid, none, or 0xHEX"),
 			 N_("[=STYLE]"));
 
   DEFINE_bool(check_sections, options::TWO_DASHES, '\0', true,
 	      N_("Check segment addresses for overlaps (default)"),
 	      N_("Do not check segment addresses for overlaps"));
 
+  DEFINE_int(compress_debug_level, options::TWO_DASHES, '\0', 1,
+	     N_("Compression level for --compress-debug-sections, from 0 "
+		"(fastest) to 9 (smallest); the default is 1, or 9 with -O"),
+	     N_("LEVEL"));
+
 #ifdef HAVE_ZLIB_H
   DEFINE_enum(compress_debug_sections, options::TWO_DASHES, '\0', "none",
               N_("Compress .debug_* sections in the output file"),
@@ -700,6 +710,11 @@ class General_options
               N_("Look for violations of the C++ One Definition Rule"),
 	      N_("Do not look for violations of the C++ One Definition Rule"));
 
+  DEFINE_string(dir_cache, options::TWO_DASHES, '\0', NULL,
+		N_("Save the names of the files in the library search "
+		   "directories in FILE, for later links to reuse"),
+		N_("FILE"));
+
   DEFINE_bool(discard_all, options::TWO_DASHES, 'x', false,
 	      N_("Delete all local symbols"), NULL);
   DEFINE_bool(discard_locals, options::TWO_DASHES, 'X', false,
@@ -778,6 +793,11 @@ class General_options
 		N_("Min fraction of empty buckets in dynamic hash"),
 		N_("FRACTION"));
 
+  DEFINE_uint(hash_bloom_bits, options::TWO_DASHES, '\0', 0,
+	      N_("Bits per symbol in the GNU hash bloom filter "
+		 "(default: chosen as by GNU ld)"),
+	      N_("BITS"));
+
   DEFINE_enum(hash_style, options::TWO_DASHES, '\0', "sysv",
 	      N_("Dynamic hash style"), N_("[sysv,gnu,both]"),
 	      {"sysv", "gnu", "both"});
@@ -878,6 +898,9 @@ class General_options
 
   DEFINE_string(output, options::TWO_DASHES, 'o', "a.out",
                 N_("Set output file name"), N_("FILE"));
+  DEFINE_bool(output_huge_pages, options::TWO_DASHES, '\0', false,
+	      N_("Ask for transparent huge pages for the output file mapping"),
+	      N_("Do not ask for huge pages for the output file (default)"));
 
   DEFINE_uint(optimize, options::EXACTLY_ONE_DASH, 'O', 0,
               N_("Optimize output file size"), N_("LEVEL"));
@@ -914,6 +937,10 @@ class General_options
   DEFINE_bool(Qy, options::EXACTLY_ONE_DASH, '\0', false,
 	      N_("Ignored for SVR4 compatibility"), NULL);
 
+  DEFINE_bool(readahead, options::TWO_DASHES, '\0', true,
+	      N_("Read input files ahead in the background (default)"),
+	      N_("Do not read input files ahead"));
+
   DEFINE_bool(emit_relocs, options::TWO_DASHES, 'q', false,
               N_("Generate relocations in output"), NULL);
 
@@ -926,6 +953,12 @@ class General_options
   DEFINE_string(retain_symbols_file, options::TWO_DASHES, '\0', NULL,
                 N_("keep only symbols listed in this file"), N_("FILE"));
 
+  DEFINE_bool(reuse_output, options::TWO_DASHES, '\0', false,
+	      N_("Overwrite an existing output file in place, reusing its "
+		 "disk blocks (not done for shared objects or PIEs, which "
+		 "running processes may have mapped)"),
+	      N_("Replace an existing output file (default)"));
+
   // -R really means -rpath, but can mean --just-symbols for
   // compatibility with GNU ld.  -rpath is always -rpath, so we list
   // it separately.
@@ -965,6 +998,11 @@ class General_options
                  "(at least versions <= 6.7)"), NULL);
   DEFINE_bool(strip_lto_sections, options::TWO_DASHES, '\0', true,
               N_("Strip LTO intermediate code sections"), NULL);
+  DEFINE_bool(stream_output, options::TWO_DASHES, '\0', true,
+              N_("Write output that cannot be mapped into memory "
+                 "one view at a time (default)"),
+              N_("Buffer output that cannot be mapped into memory "
+                 "and write it when the link completes"));
 
   DEFINE_int(stub_group_size, options::TWO_DASHES , '\0', 1,
              N_("(ARM only) The maximum distance from instructions in a group "
@@ -1176,6 +1214,9 @@ class General_options
   DEFINE_bool(origin, options::DASH_Z, '\0', false,
 	      N_("Mark DSO to indicate that needs immediate $ORIGIN "
                  "processing at runtime"), NULL);
+  DEFINE_bool(pack_relative_relocs, options::DASH_Z, '\0', false,
+	      N_("Pack relative relocations into a .relr.dyn section"),
+	      N_("Do not pack relative relocations (default)"));
   DEFINE_bool(relro, options::DASH_Z, '\0', false,
 	      N_("Where possible mark variables read-only after relocation"),
 	      N_("Don't mark variables read-only after relocation"));
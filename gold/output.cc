@@ -38,6 +38,7 @@
 #include "reloc.h"
 #include "merge.h"
 #include "descriptors.h"
+#include "workqueue.h"
 #include "output.h"
 
 // Some BSD systems still use MAP_ANON instead of MAP_ANONYMOUS
@@ -1161,6 +1162,179 @@ Output_data_reloc_base<sh_type, dynamic, size, big_endian>
     os->set_should_link_to_dynsym();
 }
 
+// Class Output_data_reloc_base::Reloc_sorter.  This sorts the keys
+// of a set of relocs which have been written to a buffer, and then
+// copies the relocs to the output view in sorted order.  Each phase
+// is split into parts which are run on separate threads.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+class Output_data_reloc_base<sh_type, dynamic, size, big_endian>::Reloc_sorter
+  : public Parallel_runner
+{
+ public:
+  Reloc_sorter(const unsigned char* unsorted, std::vector<Sort_key>* keys,
+	       unsigned char* oview, unsigned int parts)
+    : unsorted_(unsorted), keys_(keys), merged_(), oview_(oview),
+      parts_(parts), runs_(), phase_(SORT_RUNS)
+  { }
+
+  // Sort the keys and write the relocs to the output view.
+  void
+  sort_and_copy()
+  {
+    size_t count = this->keys_->size();
+
+    // Sort one run of keys per part.
+    this->runs_.resize(this->parts_ + 1);
+    for (unsigned int i = 0; i < this->parts_; ++i)
+      this->runs_[i] = count / this->parts_ * i;
+    this->runs_[this->parts_] = count;
+    this->phase_ = SORT_RUNS;
+    Workqueue::run_in_parallel(this, this->parts_);
+
+    // Merge pairs of adjacent runs until only one is left.
+    this->merged_.resize(count);
+    this->phase_ = MERGE_RUNS;
+    while (this->runs_.size() > 2)
+      {
+	unsigned int run_count = this->runs_.size() - 1;
+	Workqueue::run_in_parallel(this, (run_count + 1) / 2);
+	this->keys_->swap(this->merged_);
+	std::vector<size_t> runs;
+	for (unsigned int i = 0; i < run_count; i += 2)
+	  runs.push_back(this->runs_[i]);
+	runs.push_back(count);
+	this->runs_.swap(runs);
+      }
+
+    this->phase_ = COPY;
+    Workqueue::run_in_parallel(this, this->parts_);
+  }
+
+  void
+  run(unsigned int part)
+  {
+    switch (this->phase_)
+      {
+      case SORT_RUNS:
+	std::sort(this->keys_->begin() + this->runs_[part],
+		  this->keys_->begin() + this->runs_[part + 1],
+		  Sort_key_comparison());
+	break;
+
+      case MERGE_RUNS:
+	{
+	  // Merge runs 2 * PART and 2 * PART + 1 into MERGED_.  The
+	  // last run is copied if there is no run to merge it with.
+	  size_t begin = this->runs_[2 * part];
+	  size_t middle = this->runs_[2 * part + 1];
+	  size_t end = (2 * part + 2 < this->runs_.size()
+			? this->runs_[2 * part + 2]
+			: middle);
+	  typename std::vector<Sort_key>::const_iterator keys =
+	    this->keys_->begin();
+	  std::merge(keys + begin, keys + middle, keys + middle, keys + end,
+		     this->merged_.begin() + begin, Sort_key_comparison());
+	}
+	break;
+
+      case COPY:
+	{
+	  size_t count = this->keys_->size();
+	  size_t begin = count / this->parts_ * part;
+	  size_t end = (part + 1 == this->parts_
+			? count
+			: count / this->parts_ * (part + 1));
+	  unsigned char* pov = this->oview_ + begin * reloc_size;
+	  for (size_t i = begin; i < end; ++i)
+	    {
+	      memcpy(pov, this->unsorted_ + (*this->keys_)[i].index * reloc_size,
+		     reloc_size);
+	      pov += reloc_size;
+	    }
+	}
+	break;
+
+      default:
+	gold_unreachable();
+      }
+  }
+
+ private:
+  enum Phase
+  {
+    SORT_RUNS,
+    MERGE_RUNS,
+    COPY
+  };
+
+  // The relocs in the order they were added.
+  const unsigned char* unsorted_;
+  // The sort keys.
+  std::vector<Sort_key>* keys_;
+  // The destination of a merge.
+  std::vector<Sort_key> merged_;
+  // The output view.
+  unsigned char* oview_;
+  // The number of parts.
+  unsigned int parts_;
+  // The indexes in KEYS_ at which each sorted run starts, followed
+  // by the number of keys.
+  std::vector<size_t> runs_;
+  // The current phase.
+  Phase phase_;
+};
+
+// Write the relocations to OVIEW sorted for the dynamic linker.  The
+// relocs are first written out in the order they were added, which
+// we do on a single thread because finding the output address of an
+// input merge section is not thread safe.  The sort keys are read
+// back from the written relocs, so the symbol index and output
+// address of each reloc are only computed once.
+
+template<int sh_type, bool dynamic, int size, bool big_endian>
+void
+Output_data_reloc_base<sh_type, dynamic, size, big_endian>::write_sorted(
+    unsigned char* oview)
+{
+  typedef Reloc_types<sh_type, size, big_endian> Types;
+  typedef typename Types::Reloc Reloc;
+
+  const size_t count = this->relocs_.size();
+  unsigned char* unsorted = new unsigned char[count * reloc_size];
+  std::vector<Sort_key> keys(count);
+
+  unsigned char* pov = unsorted;
+  for (size_t i = 0; i < count; ++i)
+    {
+      const Output_reloc_type& r(this->relocs_[i]);
+      r.write(pov);
+
+      Reloc reloc(pov);
+      typename elfcpp::Elf_types<size>::Elf_WXword r_info =
+	reloc.get_r_info();
+      Sort_key& key(keys[i]);
+      key.rank = (r.is_relative()
+		  ? 0
+		  : static_cast<uint64_t>(elfcpp::elf_r_sym<size>(r_info)) + 1);
+      key.address = reloc.get_r_offset();
+      key.type = elfcpp::elf_r_type<size>(r_info);
+      key.addend = Types::get_reloc_addend_noerror(&reloc);
+      key.index = i;
+
+      pov += reloc_size;
+    }
+
+  unsigned int parts = std::max(1U,
+				std::min(Workqueue::parallel_thread_count(),
+					 static_cast<unsigned int>(count
+								   / 4096)));
+  Reloc_sorter sorter(unsorted, &keys, oview, parts);
+  sorter.sort_and_copy();
+
+  delete[] unsorted;
+}
+
 // Write out relocation data.
 
 template<int sh_type, bool dynamic, int size, bool big_endian>
@@ -1175,24 +1349,247 @@ Output_data_reloc_base<sh_type, dynamic, size, big_endian>::do_write(
   if (this->sort_relocs())
     {
       gold_assert(dynamic);
-      std::sort(this->relocs_.begin(), this->relocs_.end(),
-		Sort_relocs_comparison());
+      gold_assert(static_cast<off_t>(this->relocs_.size() * reloc_size)
+		  == oview_size);
+      this->write_sorted(oview);
+    }
+  else
+    {
+      unsigned char* pov = oview;
+      for (typename Relocs::const_iterator p = this->relocs_.begin();
+	   p != this->relocs_.end();
+	   ++p)
+	{
+	  p->write(pov);
+	  pov += reloc_size;
+	}
+
+      gold_assert(pov - oview == oview_size);
     }
 
+  of->write_output_view(off, oview_size, oview);
+
+  // We no longer need the relocation entries.
+  this->relocs_.clear();
+}
+
+// Class Output_data_relr.
+
+// Add a RELATIVE reloc for the word at ADDRESS within OD.
+
+template<int size, bool big_endian>
+bool
+Output_data_relr<size, big_endian>::add(Output_data* od, Address address)
+{
+  if ((address & (entry_size - 1)) != 0 || od->addralign() < entry_size)
+    return false;
+  this->relocs_.push_back(Relr(od, NULL, 0, address));
+  this->set_current_data_size(this->relocs_.size() * entry_size);
+  od->add_dynamic_reloc();
+  return true;
+}
+
+// Add a RELATIVE reloc for the word at ADDRESS within input section
+// SHNDX of RELOBJ.  The word is aligned in the output file if it is
+// aligned within an input section which is itself aligned.  We only
+// pack relocs in input sections which are copied to a fixed offset in
+// the output section.  The contents of merge sections and of .eh_frame
+// may move, and the remaining words of such a section no longer lie
+// at a fixed distance from its start.  A section which is relaxed
+// later still has a fixed offset at this point, and a relaxed section
+// maps linearly, so group_address handles those.
+
+template<int size, bool big_endian>
+bool
+Output_data_relr<size, big_endian>::add(Output_data* od,
+					Sized_relobj<size, big_endian>* relobj,
+					unsigned int shndx, Address address)
+{
+  if ((address & (entry_size - 1)) != 0
+      || relobj->section_addralign(shndx) < entry_size
+      || relobj->is_output_section_offset_invalid(shndx))
+    return false;
+  this->relocs_.push_back(Relr(NULL, relobj, shndx, address));
+  this->set_current_data_size(this->relocs_.size() * entry_size);
+  od->add_dynamic_reloc();
+  return true;
+}
+
+// Set the entry size of the output section.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::do_adjust_output_section(
+    Output_section* os)
+{
+  os->set_entsize(entry_size);
+}
+
+// Sort the words by input section or Output_data, then by offset.
+// The order of the groups depends on pointer values, so it is only
+// used to bring the words of a group together.
+
+template<int size, bool big_endian>
+bool
+Output_data_relr<size, big_endian>::Relr_compare::operator()(
+    const Relr& r1, const Relr& r2) const
+{
+  if (r1.relobj != r2.relobj)
+    return std::less<const void*>()(r1.relobj, r2.relobj);
+  if (r1.relobj == NULL)
+    {
+      if (r1.od != r2.od)
+	return std::less<const void*>()(r1.od, r2.od);
+    }
+  else if (r1.shndx != r2.shndx)
+    return r1.shndx < r2.shndx;
+  return r1.address < r2.address;
+}
+
+// Return the output address of offset zero in the input section or
+// Output_data of R.
+
+template<int size, bool big_endian>
+typename Output_data_relr<size, big_endian>::Address
+Output_data_relr<size, big_endian>::group_address(const Relr& r)
+{
+  if (r.relobj == NULL)
+    return r.od->address();
+  Output_section* os = r.relobj->output_section(r.shndx);
+  gold_assert(os != NULL);
+  Address off = r.relobj->get_output_section_offset(r.shndx);
+  if (off != Sized_relobj<size, big_endian>::invalid_address)
+    return os->address() + off;
+  // This is a relaxed input section; add() rejects every other kind
+  // of section without a fixed offset.
+  uint64_t address = os->output_address(r.relobj, r.shndx, 0);
+  gold_assert(address != -1ULL);
+  return address;
+}
+
+// Encode the words at offsets [BEGIN, END) of RELOCS_, which are
+// sorted and all in one group, adding BASE to each offset.  Write
+// the entries to POV unless it is NULL.  Return the number of
+// entries.
+
+template<int size, bool big_endian>
+size_t
+Output_data_relr<size, big_endian>::encode(size_t begin, size_t end,
+					   Address base,
+					   unsigned char* pov) const
+{
+  const unsigned int bits = size - 1;
+  size_t count = 0;
+  size_t i = begin;
+  while (i < end)
+    {
+      // An address entry relocates a single word.
+      Address offset = this->relocs_[i].address;
+      if (pov != NULL)
+	elfcpp::Swap<size, big_endian>::writeval(pov + count * entry_size,
+						 base + offset);
+      ++count;
+      ++i;
+
+      // Each bitmap entry relocates some of the next BITS words.
+      Address next = offset + entry_size;
+      while (i < end)
+	{
+	  Address bitmap = 0;
+	  while (i < end && this->relocs_[i].address - next < bits * entry_size)
+	    {
+	      unsigned int bit = (this->relocs_[i].address - next) / entry_size;
+	      bitmap |= static_cast<Address>(1) << bit;
+	      ++i;
+	    }
+	  if (bitmap == 0)
+	    break;
+	  if (pov != NULL)
+	    elfcpp::Swap<size, big_endian>::writeval(pov + count * entry_size,
+						     (bitmap << 1) | 1);
+	  ++count;
+	  next += bits * entry_size;
+	}
+    }
+  return count;
+}
+
+// Set the final data size.  The words of each group are encoded
+// separately, so the size does not depend on the output addresses.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::set_final_data_size()
+{
+  std::sort(this->relocs_.begin(), this->relocs_.end(), Relr_compare());
+
+  // Drop duplicate words.
+  size_t count = 0;
+  for (size_t i = 0; i < this->relocs_.size(); ++i)
+    {
+      if (count > 0
+	  && same_group(this->relocs_[count - 1], this->relocs_[i])
+	  && this->relocs_[count - 1].address == this->relocs_[i].address)
+	continue;
+      this->relocs_[count] = this->relocs_[i];
+      ++count;
+    }
+  this->relocs_.resize(count, Relr(NULL, NULL, 0, 0));
+
+  size_t entries = 0;
+  size_t begin = 0;
+  while (begin < count)
+    {
+      size_t end = begin + 1;
+      while (end < count && same_group(this->relocs_[begin], this->relocs_[end]))
+	++end;
+      entries += this->encode(begin, end, 0, NULL);
+      begin = end;
+    }
+  this->set_data_size(entries * entry_size);
+}
+
+// Write out the packed relocs, with the groups in address order.
+
+template<int size, bool big_endian>
+void
+Output_data_relr<size, big_endian>::do_write(Output_file* of)
+{
+  const off_t off = this->offset();
+  const off_t oview_size = this->data_size();
+  unsigned char* const oview = of->get_output_view(off, oview_size);
+
+  // Each group is the output address of its first word and the
+  // range of its words in RELOCS_.
+  std::vector<std::pair<Address, std::pair<size_t, size_t> > > groups;
+  const size_t count = this->relocs_.size();
+  size_t begin = 0;
+  while (begin < count)
+    {
+      size_t end = begin + 1;
+      while (end < count && same_group(this->relocs_[begin], this->relocs_[end]))
+	++end;
+      Address base = group_address(this->relocs_[begin]);
+      groups.push_back(std::make_pair(base + this->relocs_[begin].address,
+				      std::make_pair(begin, end)));
+      begin = end;
+    }
+  std::sort(groups.begin(), groups.end());
+
   unsigned char* pov = oview;
-  for (typename Relocs::const_iterator p = this->relocs_.begin();
-       p != this->relocs_.end();
-       ++p)
+  for (size_t i = 0; i < groups.size(); ++i)
     {
-      p->write(pov);
-      pov += reloc_size;
+      size_t gbegin = groups[i].second.first;
+      size_t gend = groups[i].second.second;
+      Address base = groups[i].first - this->relocs_[gbegin].address;
+      pov += this->encode(gbegin, gend, base, pov) * entry_size;
     }
 
   gold_assert(pov - oview == oview_size);
 
   of->write_output_view(off, oview_size, oview);
 
-  // We no longer need the relocation entries.
+  // We no longer need the relocs.
   this->relocs_.clear();
 }
 
@@ -4558,6 +4955,9 @@ Output_file::Output_file(const char* name)
     file_size_(0),
     base_(NULL),
     map_is_anonymous_(false),
+    is_streaming_(false),
+    allocated_size_(0),
+    reused_size_(0),
     is_temporary_(false)
 {
 }
@@ -4633,6 +5033,11 @@ Output_file::open_base_file(const char* base_name, bool writable)
   this->o_ = o;
   this->file_size_ = s.st_size;
 
+  // Updating the file in place doesn't need any new disk blocks
+  // unless the file is sparse or grows.
+  if (static_cast<off_t>(s.st_blocks) * 512 >= s.st_size)
+    this->allocated_size_ = s.st_size;
+
   if (!this->map_no_anonymous(writable))
     {
       release_descriptor(o, true);
@@ -4669,7 +5074,10 @@ Output_file::open(off_t file_size)
     {
       if (strcmp(this->name_, "-") == 0)
 	this->o_ = STDOUT_FILENO;
-      else
+      else if (parameters->options().reuse_output())
+	this->o_ = this->open_for_reuse();
+
+      if (this->o_ < 0)
 	{
 	  struct stat s;
 	  if (::stat(this->name_, &s) == 0
@@ -4701,6 +5109,78 @@ Output_file::open(off_t file_size)
   this->map();
 }
 
+// Open the existing output file so that we can write the new output
+// over it, rather than unlinking it and allocating and zeroing every
+// page again.  We only do this for a regular file with a single link,
+// since writing in place changes the file seen through every name.
+// If the file is an executable that's currently being executed, the
+// open fails with ETXTBSY and we fall back on replacing the file.  The
+// kernel gives no such protection to a shared object, which running
+// processes may have mapped; writing over it would corrupt it
+// underneath them.  So we never reuse a file when the output is
+// ET_DYN, nor when the existing file is an ELF ET_DYN file.
+
+int
+Output_file::open_for_reuse()
+{
+  if (parameters->options().output_is_position_independent())
+    return -1;
+
+  struct stat s;
+  if (::lstat(this->name_, &s) != 0
+      || !S_ISREG(s.st_mode)
+      || s.st_nlink != 1
+      || s.st_size == 0)
+    return -1;
+
+  int o = open_descriptor(-1, this->name_, O_RDWR, 0);
+  if (o < 0)
+    return -1;
+
+  unsigned char ehdr[elfcpp::EI_NIDENT + 2];
+  if (::pread(o, ehdr, sizeof ehdr, 0) == static_cast<ssize_t>(sizeof ehdr)
+      && ehdr[elfcpp::EI_MAG0] == elfcpp::ELFMAG0
+      && ehdr[elfcpp::EI_MAG1] == elfcpp::ELFMAG1
+      && ehdr[elfcpp::EI_MAG2] == elfcpp::ELFMAG2
+      && ehdr[elfcpp::EI_MAG3] == elfcpp::ELFMAG3)
+    {
+      unsigned char* p = ehdr + elfcpp::EI_NIDENT;
+      unsigned int e_type = (ehdr[elfcpp::EI_DATA] == elfcpp::ELFDATA2MSB
+			     ? (p[0] << 8) | p[1]
+			     : (p[1] << 8) | p[0]);
+      if (e_type == elfcpp::ET_DYN)
+	{
+	  release_descriptor(o, true);
+	  return -1;
+	}
+    }
+
+  // Truncate or grow the file to the new size.  Growing it leaves a
+  // hole, for which map_no_anonymous will allocate blocks.
+  if (::ftruncate(o, this->file_size_) < 0)
+    {
+      release_descriptor(o, true);
+      return -1;
+    }
+
+  // Add execute permission where read permissions already exist and
+  // where the umask permits, as we would for a new file.
+  if (!parameters->options().relocatable())
+    {
+      int mask = ::umask(0);
+      ::umask(mask);
+      mode_t mode = s.st_mode | ((s.st_mode & 0444) >> 2);
+      if (mode != s.st_mode)
+	::fchmod(o, mode & ~mask);
+    }
+
+  off_t kept_size = std::min(s.st_size, this->file_size_);
+  if (static_cast<off_t>(s.st_blocks) * 512 >= s.st_size)
+    this->allocated_size_ = kept_size;
+  this->reused_size_ = kept_size;
+  return o;
+}
+
 // Resize the output file.
 
 void
@@ -4709,7 +5189,13 @@ Output_file::resize(off_t file_size)
   // If the mmap is mapping an anonymous memory buffer, this is easy:
   // just mremap to the new size.  If it's mapping to a file, we want
   // to unmap to flush to the file, then remap after growing the file.
-  if (this->map_is_anonymous_)
+  if (this->is_streaming_)
+    {
+      if (::ftruncate(this->o_, file_size) < 0)
+	gold_fatal(_("%s: ftruncate: %s"), this->name_, strerror(errno));
+      this->file_size_ = file_size;
+    }
+  else if (this->map_is_anonymous_)
     {
       void* base = ::mremap(this->base_, this->file_size_, file_size,
                             MREMAP_MAYMOVE);
@@ -4739,6 +5225,7 @@ Output_file::map_anonymous()
     {
       this->map_is_anonymous_ = true;
       this->base_ = static_cast<unsigned char*>(base);
+      advise_mapping(base, this->file_size_);
       return true;
     }
   return false;
@@ -4769,9 +5256,17 @@ Output_file::map_no_anonymous(bool writable)
   // disk blocks.  If the disk is out of space at that point, the
   // output file will wind up incomplete, but we will have already
   // exited.  The alternative to fallocate would be to use fdatasync,
-  // but that would be a more significant performance hit.
-  if (writable && ::posix_fallocate(o, 0, this->file_size_) < 0)
-    gold_fatal(_("%s: %s"), this->name_, strerror(errno));
+  // but that would be a more significant performance hit.  We skip
+  // the part of the file we know already has blocks.
+  if (this->allocated_size_ > this->file_size_)
+    this->allocated_size_ = this->file_size_;
+  if (writable && this->allocated_size_ < this->file_size_)
+    {
+      if (::posix_fallocate(o, this->allocated_size_,
+			    this->file_size_ - this->allocated_size_) < 0)
+	gold_fatal(_("%s: %s"), this->name_, strerror(errno));
+      this->allocated_size_ = this->file_size_;
+    }
 
   // Map the file into memory.
   int prot = PROT_READ;
@@ -4787,16 +5282,58 @@ Output_file::map_no_anonymous(bool writable)
 
   this->map_is_anonymous_ = false;
   this->base_ = static_cast<unsigned char*>(base);
+  advise_mapping(base, this->file_size_);
   return true;
 }
 
+// Pass hints about a mapping of the output file to the kernel.  The
+// output is written all over at once, so huge pages save many page
+// faults and TLB misses for a large file.  The hints are only
+// advice, so we ignore errors.
+
+void
+Output_file::advise_mapping(void* base, off_t size)
+{
+#ifdef MADV_HUGEPAGE
+  if (parameters->options_valid()
+      && parameters->options().output_huge_pages())
+    ::madvise(base, size, MADV_HUGEPAGE);
+#endif
+}
+
 // Map the file into memory.
 
 void
 Output_file::map()
 {
   if (this->map_no_anonymous(true))
-    return;
+    {
+      // If we are writing over an old output file, clear its contents
+      // now.  We don't write every byte of the file, and the parts we
+      // skip must read as zero, as they would in a new file.  The pages
+      // are normally still cached, so this is much cheaper than
+      // allocating new ones.
+      if (this->reused_size_ > 0)
+	{
+	  memset(this->base_, 0, this->reused_size_);
+	  this->reused_size_ = 0;
+	}
+      return;
+    }
+
+  // We can't clear the contents of an old output file through a
+  // mapping, and the fallbacks below discard them.
+  this->reused_size_ = 0;
+  this->allocated_size_ = 0;
+
+  // If we can't map the file but can write to arbitrary offsets in
+  // it, write each view as it is released rather than holding the
+  // whole file in memory until we close it.
+  if (this->can_stream())
+    {
+      this->is_streaming_ = true;
+      return;
+    }
 
   // The mmap call might fail because of file system issues: the file
   // system might not support mmap at all, or it might not support
@@ -4811,6 +5348,124 @@ Output_file::map()
              strerror(errno));
 }
 
+// Return whether we can stream the output file.  The file must be a
+// regular file open for reading and writing which we are writing
+// from the start, so that positioned writes put the data where an
+// mmap would have.  We don't stream incremental links, which read
+// the output file back through long-lived views.
+
+bool
+Output_file::can_stream()
+{
+  const int o = this->o_;
+  struct stat statbuf;
+  if (o < 0
+      || this->is_temporary_
+      || !parameters->options().stream_output()
+      || parameters->incremental()
+      || ::fstat(o, &statbuf) != 0
+      || !S_ISREG(statbuf.st_mode)
+      || ::lseek(o, 0, SEEK_CUR) != 0)
+    return false;
+
+  // We need to read back what we have written for read/write views,
+  // so the descriptor must be open for both.
+  int flags = ::fcntl(o, F_GETFL);
+  if (flags < 0
+      || (flags & O_ACCMODE) != O_RDWR
+      || (flags & O_APPEND) != 0)
+    return false;
+
+  // Discard any old contents and set the file size, so that any parts
+  // we never write read back as zeroes, as they would in a new file.
+  if (::ftruncate(o, 0) < 0 || ::ftruncate(o, this->file_size_) < 0)
+    return false;
+
+  return true;
+}
+
+// Allocate a buffer for a view when streaming.
+
+unsigned char*
+Output_file::get_streaming_view(off_t start, size_t size,
+				bool is_input_output, bool read_contents)
+{
+  unsigned char* view = new unsigned char[is_input_output ? 2 * size : size];
+  if (!is_input_output && !read_contents)
+    {
+      memset(view, 0, size);
+      return view;
+    }
+
+  size_t bytes_read = 0;
+  while (bytes_read < size)
+    {
+      ssize_t got = ::pread(this->o_, view + bytes_read, size - bytes_read,
+			    start + bytes_read);
+      if (got < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pread: %s"), this->name_, strerror(errno));
+	}
+      if (got == 0)
+	gold_fatal(_("%s: pread: unexpected EOF"), this->name_);
+      bytes_read += got;
+    }
+
+  if (is_input_output)
+    memcpy(view + size, view, size);
+  return view;
+}
+
+// Write back a read/write view when streaming.  Other tasks may be
+// changing other parts of the same range at the same time, so we
+// only write the runs of bytes which differ from what we read.
+
+void
+Output_file::write_streaming_input_output_view(off_t start, size_t size,
+					       unsigned char* view)
+{
+  const unsigned char* orig = view + size;
+  size_t i = 0;
+  while (i < size)
+    {
+      if (view[i] == orig[i])
+	{
+	  ++i;
+	  continue;
+	}
+      size_t run_start = i;
+      while (i < size && view[i] != orig[i])
+	++i;
+      this->pwrite_all(start + run_start, view + run_start, i - run_start);
+    }
+  delete[] view;
+}
+
+// Write data to the file at a given offset when streaming.
+
+void
+Output_file::pwrite_all(off_t offset, const void* data, size_t len)
+{
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  while (len > 0)
+    {
+      ssize_t bytes_written = ::pwrite(this->o_, p, len, offset);
+      if (bytes_written < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  gold_fatal(_("%s: pwrite: %s"), this->name_, strerror(errno));
+	}
+      if (bytes_written == 0)
+	gold_fatal(_("%s: pwrite: unexpected 0 return-value"), this->name_);
+      p += bytes_written;
+      offset += bytes_written;
+      len -= bytes_written;
+    }
+}
+
 // Unmap the file from memory.
 
 void
@@ -4846,7 +5501,8 @@ Output_file::close()
             }
         }
     }
-  this->unmap();
+  if (!this->is_streaming_)
+    this->unmap();
 
   // We don't close stdout or stderr
   if (this->o_ != STDOUT_FILENO
@@ -5112,6 +5768,26 @@ template
 class Output_relocatable_relocs<elfcpp::SHT_RELA, 64, true>;
 #endif
 
+#ifdef HAVE_TARGET_32_LITTLE
+template
+class Output_data_relr<32, false>;
+#endif
+
+#ifdef HAVE_TARGET_32_BIG
+template
+class Output_data_relr<32, true>;
+#endif
+
+#ifdef HAVE_TARGET_64_LITTLE
+template
+class Output_data_relr<64, false>;
+#endif
+
+#ifdef HAVE_TARGET_64_BIG
+template
+class Output_data_relr<64, true>;
+#endif
+
 #ifdef HAVE_TARGET_32_LITTLE
 template
 class Output_data_group<32, false>;
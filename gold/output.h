@@ -1369,6 +1369,109 @@ class Output_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   Addend addend_;
 };
 
+// Output_data_relr holds the RELATIVE relocations of a position
+// independent output file in the packed SHT_RELR format, for
+// -z pack-relative-relocs.  An even entry is the address of a word to
+// relocate.  An odd entry is a bitmap of the SIZE - 1 words which
+// follow the last word covered by the previous entry.  The addend of
+// each reloc is the link-time value already stored in the word, so
+// the target must apply each of these relocs when relocating the
+// section, as it would for SHT_REL.
+
+template<int size, bool big_endian>
+class Output_data_relr : public Output_section_data_build
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  static const int entry_size = size / 8;
+
+  Output_data_relr()
+    : Output_section_data_build(entry_size), relocs_()
+  { }
+
+  // Add a RELATIVE reloc for the word at ADDRESS within OD.  Return
+  // false if the word may not be aligned, in which case the caller
+  // must use an ordinary reloc.
+  bool
+  add(Output_data* od, Address address);
+
+  // Add a RELATIVE reloc for the word at ADDRESS within input section
+  // SHNDX of RELOBJ, which is in the output section OD.
+  bool
+  add(Output_data* od, Sized_relobj<size, big_endian>* relobj,
+      unsigned int shndx, Address address);
+
+ protected:
+  // Set the final data size.
+  void
+  set_final_data_size();
+
+  // Write out the data.
+  void
+  do_write(Output_file*);
+
+  // Set the entry size.
+  void
+  do_adjust_output_section(Output_section* os);
+
+  // Write to a map file.
+  void
+  do_print_to_mapfile(Mapfile* mapfile) const
+  { mapfile->print_output_data(this, _("** packed relocs")); }
+
+ private:
+  // A word to relocate.  The offsets of the words within an input
+  // section or an Output_data are known before the output addresses,
+  // so we encode the words of each one separately.
+  struct Relr
+  {
+    Relr(Output_data* od_arg, Sized_relobj<size, big_endian>* relobj_arg,
+	 unsigned int shndx_arg, Address address_arg)
+      : od(od_arg), relobj(relobj_arg), shndx(shndx_arg),
+	address(address_arg)
+    { }
+
+    // The Output_data holding the word, if RELOBJ is NULL.
+    Output_data* od;
+    // The object holding the word, or NULL.
+    Sized_relobj<size, big_endian>* relobj;
+    // The input section holding the word, if RELOBJ is not NULL.
+    unsigned int shndx;
+    // The offset of the word within the input section or OD.
+    Address address;
+  };
+
+  // Sort the words by input section or Output_data, then by offset.
+  struct Relr_compare
+  {
+    bool
+    operator()(const Relr&, const Relr&) const;
+  };
+
+  // Return whether two words are in the same input section or
+  // Output_data.
+  static bool
+  same_group(const Relr& r1, const Relr& r2)
+  {
+    return (r1.relobj == r2.relobj
+	    && (r1.relobj == NULL ? r1.od == r2.od : r1.shndx == r2.shndx));
+  }
+
+  // Return the output address of offset zero in the input section
+  // or Output_data of R.
+  static Address
+  group_address(const Relr& r);
+
+  // Encode the words at offsets [BEGIN, END) of RELOCS_ from BASE.
+  size_t
+  encode(size_t begin, size_t end, Address base, unsigned char* pov) const;
+
+  typedef std::vector<Relr> Relrs;
+
+  // The words to relocate.
+  Relrs relocs_;
+};
+
 // Output_data_reloc_generic is a non-template base class for
 // Output_data_reloc_base.  This gives the generic code a way to hold
 // a pointer to a reloc section.
@@ -1424,9 +1527,20 @@ class Output_data_reloc_base : public Output_data_reloc_generic
 
   // Construct the section.
   Output_data_reloc_base(bool sort_relocs)
-    : Output_data_reloc_generic(size, sort_relocs)
+    : Output_data_reloc_generic(size, sort_relocs), relr_(NULL),
+      relr_type_(0)
   { }
 
+  // Pack the RELATIVE relocs of type RELATIVE_TYPE into RELR where
+  // possible, rather than adding them to this section.
+  void
+  set_relr_section(Output_data_relr<size, big_endian>* relr,
+		   unsigned int relative_type)
+  {
+    this->relr_ = relr;
+    this->relr_type_ = relative_type;
+  }
+
  protected:
   // Write out the data.
   void
@@ -1460,19 +1574,82 @@ class Output_data_reloc_base : public Output_data_reloc_generic
       relobj->add_dyn_reloc(this->relocs_.size() - 1);
   }
 
+  // Add a RELATIVE reloc of type TYPE for ADDRESS in OD to the packed
+  // relocs, if there are any and it can be packed.  Return whether
+  // it was added.
+  bool
+  add_packed_relative(unsigned int type, Output_data* od, Address address)
+  {
+    return (this->relr_ != NULL
+	    && type == this->relr_type_
+	    && this->relr_->add(od, address));
+  }
+
+  bool
+  add_packed_relative(unsigned int type, Output_data* od,
+		      Sized_relobj<size, big_endian>* relobj,
+		      unsigned int shndx, Address address)
+  {
+    return (this->relr_ != NULL
+	    && type == this->relr_type_
+	    && this->relr_->add(od, relobj, shndx, address));
+  }
+
  private:
   typedef std::vector<Output_reloc_type> Relocs;
 
+  typedef typename elfcpp::Elf_types<size>::Elf_Swxword Addend;
+
+  // The key used to sort a reloc which has already been written out.
+  // This orders the relocs the same way as Output_reloc::sort_before,
+  // but without looking up the symbol index and output address again
+  // for every comparison.
+  struct Sort_key
+  {
+    // Zero for a relative reloc, otherwise one more than the symbol
+    // index.
+    uint64_t rank;
+    // The output address.
+    Address address;
+    // The reloc type.
+    unsigned int type;
+    // The addend, or zero for SHT_REL.
+    Addend addend;
+    // The index of the reloc in the order it was added.
+    size_t index;
+  };
+
   // The class used to sort the relocations.
-  struct Sort_relocs_comparison
+  struct Sort_key_comparison
   {
     bool
-    operator()(const Output_reloc_type& r1, const Output_reloc_type& r2) const
-    { return r1.sort_before(r2); }
+    operator()(const Sort_key& k1, const Sort_key& k2) const
+    {
+      if (k1.rank != k2.rank)
+	return k1.rank < k2.rank;
+      if (k1.address != k2.address)
+	return k1.address < k2.address;
+      if (k1.type != k2.type)
+	return k1.type < k2.type;
+      if (k1.addend != k2.addend)
+	return k1.addend < k2.addend;
+      return k1.index < k2.index;
+    }
   };
 
+  // A class to sort and copy the relocations on several threads.
+  class Reloc_sorter;
+
+  // Write the relocations to OVIEW sorted for the dynamic linker.
+  void
+  write_sorted(unsigned char* oview);
+
   // The relocations in this section.
   Relocs relocs_;
+  // The section holding packed relative relocs, or NULL.
+  Output_data_relr<size, big_endian>* relr_;
+  // The type of the relocs to pack into RELR_.
+  unsigned int relr_type_;
 };
 
 // The class which callers actually create.
@@ -1536,15 +1713,19 @@ class Output_data_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>
   void
   add_global_relative(Symbol* gsym, unsigned int type, Output_data* od,
                       Address address)
-  { this->add(od, Output_reloc_type(gsym, type, od, address, true, true)); }
+  {
+    if (!this->add_packed_relative(type, od, address))
+      this->add(od, Output_reloc_type(gsym, type, od, address, true, true));
+  }
 
   void
   add_global_relative(Symbol* gsym, unsigned int type, Output_data* od,
                       Sized_relobj<size, big_endian>* relobj,
                       unsigned int shndx, Address address)
   {
-    this->add(od, Output_reloc_type(gsym, type, relobj, shndx, address,
-                                    true, true));
+    if (!this->add_packed_relative(type, od, relobj, shndx, address))
+      this->add(od, Output_reloc_type(gsym, type, relobj, shndx, address,
+				      true, true));
   }
 
   // Add a global relocation which does not use a symbol for the relocation,
@@ -1592,8 +1773,9 @@ class Output_data_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>
 	             unsigned int local_sym_index, unsigned int type,
 	             Output_data* od, Address address)
   {
-    this->add(od, Output_reloc_type(relobj, local_sym_index, type, od,
-                                    address, true, true, false));
+    if (!this->add_packed_relative(type, od, address))
+      this->add(od, Output_reloc_type(relobj, local_sym_index, type, od,
+				      address, true, true, false));
   }
 
   void
@@ -1601,8 +1783,9 @@ class Output_data_reloc<elfcpp::SHT_REL, dynamic, size, big_endian>
 	             unsigned int local_sym_index, unsigned int type,
 	             Output_data* od, unsigned int shndx, Address address)
   {
-    this->add(od, Output_reloc_type(relobj, local_sym_index, type, shndx,
-				    address, true, true, false));
+    if (!this->add_packed_relative(type, od, relobj, shndx, address))
+      this->add(od, Output_reloc_type(relobj, local_sym_index, type, shndx,
+				      address, true, true, false));
   }
 
   // Add a local relocation which does not use a symbol for the relocation,
@@ -1734,15 +1917,21 @@ class Output_data_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
   void
   add_global_relative(Symbol* gsym, unsigned int type, Output_data* od,
 	              Address address, Addend addend)
-  { this->add(od, Output_reloc_type(gsym, type, od, address, addend, true,
-				    true)); }
+  {
+    if (!this->add_packed_relative(type, od, address))
+      this->add(od, Output_reloc_type(gsym, type, od, address, addend, true,
+				      true));
+  }
 
   void
   add_global_relative(Symbol* gsym, unsigned int type, Output_data* od,
                       Sized_relobj<size, big_endian>* relobj,
                       unsigned int shndx, Address address, Addend addend)
-  { this->add(od, Output_reloc_type(gsym, type, relobj, shndx, address,
-                                    addend, true, true)); }
+  {
+    if (!this->add_packed_relative(type, od, relobj, shndx, address))
+      this->add(od, Output_reloc_type(gsym, type, relobj, shndx, address,
+				      addend, true, true));
+  }
 
   // Add a global relocation which does not use a symbol for the relocation,
   // but which gets its addend from a symbol.
@@ -1789,8 +1978,9 @@ class Output_data_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
 	             unsigned int local_sym_index, unsigned int type,
 	             Output_data* od, Address address, Addend addend)
   {
-    this->add(od, Output_reloc_type(relobj, local_sym_index, type, od, address,
-				    addend, true, true, false));
+    if (!this->add_packed_relative(type, od, address))
+      this->add(od, Output_reloc_type(relobj, local_sym_index, type, od,
+				      address, addend, true, true, false));
   }
 
   void
@@ -1799,8 +1989,9 @@ class Output_data_reloc<elfcpp::SHT_RELA, dynamic, size, big_endian>
 	             Output_data* od, unsigned int shndx, Address address,
 	             Addend addend)
   {
-    this->add(od, Output_reloc_type(relobj, local_sym_index, type, shndx,
-                                    address, addend, true, true, false));
+    if (!this->add_packed_relative(type, od, relobj, shndx, address))
+      this->add(od, Output_reloc_type(relobj, local_sym_index, type, shndx,
+				      address, addend, true, true, false));
   }
 
   // Add a local relocation which does not use a symbol for the relocation,
@@ -3394,6 +3585,16 @@ class Output_section : public Output_data
   // with index SHNDX.  Return NULL if none is found.
   const Output_relaxed_input_section*
   find_relaxed_input_section(const Relobj* object, unsigned int shndx) const;
+
+  // Build the look-up maps for merge and relaxed input sections if they
+  // are not valid.  After this, input sections may be looked up from
+  // several threads at once, until the section is changed.
+  void
+  build_lookup_maps_if_needed() const
+  {
+    if (!this->lookup_maps_->is_valid())
+      this->build_lookup_maps();
+  }
   
   // Whether section offsets need adjustment due to relaxation.
   bool
@@ -4238,51 +4439,85 @@ class Output_file
   filename()
   { return this->name_; }
 
-  // We currently always use mmap which makes the view handling quite
-  // simple.  In the future we may support other approaches.
+  // We normally use mmap which makes the view handling quite simple.
+  // When the output file can not be mapped but supports positioned
+  // writes, we stream it instead: each view is a separate buffer
+  // which is written to the file when the view is released.
 
   // Write data to the output file.
   void
   write(off_t offset, const void* data, size_t len)
-  { memcpy(this->base_ + offset, data, len); }
+  {
+    if (this->is_streaming_)
+      this->pwrite_all(offset, data, len);
+    else
+      memcpy(this->base_ + offset, data, len);
+  }
 
   // Get a buffer to use to write to the file, given the offset into
-  // the file and the size.
+  // the file and the size.  When streaming, the buffer starts out
+  // zeroed, not with the current contents of the file.
   unsigned char*
   get_output_view(off_t start, size_t size)
   {
     gold_assert(start >= 0
                 && start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streaming_)
+      return this->get_streaming_view(start, size, false);
     return this->base_ + start;
   }
 
   // VIEW must have been returned by get_output_view.  Write the
   // buffer to the file, passing in the offset and the size.
   void
-  write_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_output_view(off_t start, size_t size, unsigned char* view)
+  {
+    if (this->is_streaming_)
+      {
+	this->pwrite_all(start, view, size);
+	delete[] view;
+      }
+  }
 
   // Get a read/write buffer.  This is used when we want to write part
   // of the file, read it in, and write it again.
   unsigned char*
   get_input_output_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    gold_assert(start >= 0
+                && start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streaming_)
+      return this->get_streaming_view(start, size, true);
+    return this->base_ + start;
+  }
 
   // Write a read/write buffer back to the file.
   void
-  write_input_output_view(off_t, size_t, unsigned char*)
-  { }
+  write_input_output_view(off_t start, size_t size, unsigned char* view)
+  {
+    if (this->is_streaming_)
+      this->write_streaming_input_output_view(start, size, view);
+  }
 
   // Get a read buffer.  This is used when we just want to read part
   // of the file back it in.
   const unsigned char*
   get_input_view(off_t start, size_t size)
-  { return this->get_output_view(start, size); }
+  {
+    gold_assert(start >= 0
+                && start + static_cast<off_t>(size) <= this->file_size_);
+    if (this->is_streaming_)
+      return this->get_streaming_view(start, size, false, true);
+    return this->base_ + start;
+  }
 
   // Release a read bfufer.
   void
-  free_input_view(off_t, size_t, const unsigned char*)
-  { }
+  free_input_view(off_t, size_t, const unsigned char* view)
+  {
+    if (this->is_streaming_)
+      delete[] view;
+  }
 
  private:
   // Map the file into memory or, if that fails, allocate anonymous
@@ -4302,6 +4537,39 @@ class Output_file
   void
   unmap();
 
+  // Try to open the existing output file for writing in place.
+  // Returns the descriptor, or -1 if it can't be reused.
+  int
+  open_for_reuse();
+
+  // Pass hints about how we will use a mapping of SIZE bytes at BASE.
+  static void
+  advise_mapping(void* base, off_t size);
+
+  // Return whether we can write the file with positioned writes
+  // rather than mapping it.
+  bool
+  can_stream();
+
+  // Allocate a buffer for a view when streaming.  If IS_INPUT_OUTPUT
+  // is true, the buffer is followed by a copy of the original
+  // contents, so that only the bytes the caller changed are written
+  // back.  If READ_CONTENTS is true, read the current contents of the
+  // file into the buffer; otherwise, zero it.
+  unsigned char*
+  get_streaming_view(off_t start, size_t size, bool is_input_output,
+		     bool read_contents = false);
+
+  // Write back the changed parts of a view returned by
+  // get_streaming_view with IS_INPUT_OUTPUT set, and free it.
+  void
+  write_streaming_input_output_view(off_t start, size_t size,
+				    unsigned char* view);
+
+  // Write LEN bytes of DATA to the file at OFFSET.
+  void
+  pwrite_all(off_t offset, const void* data, size_t len);
+
   // File name.
   const char* name_;
   // File descriptor.
@@ -4312,6 +4580,15 @@ class Output_file
   unsigned char* base_;
   // True iff base_ points to a memory buffer rather than an output file.
   bool map_is_anonymous_;
+  // True if the file is not mapped, and views are written to the
+  // file as they are released.
+  bool is_streaming_;
+  // The number of bytes at the start of the file which already have
+  // disk blocks allocated, so need not be passed to posix_fallocate.
+  off_t allocated_size_;
+  // The number of bytes at the start of the file which hold the
+  // contents of an earlier output file we are writing over.
+  off_t reused_size_;
   // True if this is a temporary file which should not be output.
   bool is_temporary_;
 };
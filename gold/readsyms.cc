@@ -924,4 +924,37 @@ Read_script::get_name() const
   return ret;
 }
 
+// Class Readahead_inputs.
+
+void
+Readahead_inputs::run(Workqueue*)
+{
+  this->readahead_arguments(this->cmdline_->begin(), this->cmdline_->end());
+}
+
+void
+Readahead_inputs::readahead_arguments(
+    Input_argument_list::const_iterator begin,
+    Input_argument_list::const_iterator end)
+{
+  for (Input_argument_list::const_iterator p = begin; p != end; ++p)
+    {
+      if (p->is_group())
+	this->readahead_arguments(p->group()->begin(), p->group()->end());
+      else if (p->is_lib())
+	this->readahead_arguments(p->lib()->begin(), p->lib()->end());
+      else
+	{
+	  const Input_file_argument& arg(p->file());
+	  // A name starting with '=' is relative to the sysroot, which
+	  // Input_file::find_file handles.
+	  if (!arg.is_lib()
+	      && !arg.is_searched_file()
+	      && arg.extra_search_path() == NULL
+	      && arg.name()[0] != '=')
+	    readahead_file(arg.name());
+	}
+    }
+}
+
 } // End namespace gold.
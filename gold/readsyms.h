@@ -494,6 +494,45 @@ class Read_script : public Task
   Task_token* next_blocker_;
 };
 
+// This Task starts reading the input files named on the command line
+// in the background, in command line order, so that the Read_symbols
+// tasks are less likely to wait for the disk.  It only gives hints to
+// the system, and does not wait for any data.  Libraries found by
+// searching the library path are left to Read_symbols.
+
+class Readahead_inputs : public Task
+{
+ public:
+  Readahead_inputs(const Command_line* cmdline)
+    : cmdline_(cmdline)
+  { }
+
+  // The standard Task methods.
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*);
+
+  std::string
+  get_name() const
+  { return "Readahead_inputs"; }
+
+ private:
+  // Read ahead the files in a list of input arguments.
+  void
+  readahead_arguments(Input_argument_list::const_iterator begin,
+		      Input_argument_list::const_iterator end);
+
+  const Command_line* cmdline_;
+};
+
 } // end namespace gold
 
 #endif // !defined(GOLD_READSYMS_H)
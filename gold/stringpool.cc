@@ -28,6 +28,7 @@
 
 #include "output.h"
 #include "parameters.h"
+#include "workqueue.h"
 #include "stringpool.h"
 
 namespace gold
@@ -233,9 +234,36 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
 						      size_t length,
 						      bool copy,
 						      Key* pkey)
+{
+  return this->add_hashkey(Hashkey(s, length), copy, pkey);
+}
+
+// Add a string whose hash code has already been computed.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_with_hash(const Stringpool_char* s,
+						    size_t length,
+						    size_t hash_code,
+						    bool copy,
+						    Key* pkey)
+{
+  return this->add_hashkey(Hashkey(s, length, hash_code), copy, pkey);
+}
+
+// Add the string described by HK to the pool.
+
+template<typename Stringpool_char>
+const Stringpool_char*
+Stringpool_template<Stringpool_char>::add_hashkey(const Hashkey& hkarg,
+						  bool copy,
+						  Key* pkey)
 {
   typedef std::pair<typename String_set_type::iterator, bool> Insert_type;
 
+  const Stringpool_char* s = hkarg.string;
+  size_t length = hkarg.length;
+
   // We add 1 so that 0 is always invalid.
   const Key k = this->key_to_offset_.size() + 1;
 
@@ -244,7 +272,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
       // When we don't need to copy the string, we can call insert
       // directly.
 
-      std::pair<Hashkey, Hashval> element(Hashkey(s, length), k);
+      std::pair<Hashkey, Hashval> element(hkarg, k);
 
       Insert_type ins = this->string_set_.insert(element);
 
@@ -271,7 +299,7 @@ Stringpool_template<Stringpool_char>::add_with_length(const Stringpool_char* s,
   // canonicalize it by copying it into the canonical list. The hash
   // code will only be computed once.
 
-  Hashkey hk(s, length);
+  Hashkey hk(hkarg);
   typename String_set_type::const_iterator p = this->string_set_.find(hk);
   if (p != this->string_set_.end())
     {
@@ -360,6 +388,52 @@ Stringpool_template<Stringpool_char>::is_suffix(const Stringpool_char* s1,
   return memcmp(s1, s2 + len2 - len1, len1 * sizeof(Stringpool_char)) == 0;
 }
 
+// Class Stringpool_template::Suffix_finder.  After the strings have
+// been sorted, part I of this sets IS_SUFFIX[J] for each J in the Ith
+// range of the sorted strings to whether string J is a suffix of
+// string J - 1.
+
+template<typename Stringpool_char>
+class Stringpool_template<Stringpool_char>::Suffix_finder
+  : public Parallel_runner
+{
+ public:
+  Suffix_finder(const std::vector<Stringpool_sort_info>& v,
+		std::vector<unsigned char>* is_suffix, unsigned int parts)
+    : v_(v), is_suffix_(is_suffix), parts_(parts)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t count = this->v_.size();
+    size_t begin = count / this->parts_ * part;
+    size_t end = (part + 1 == this->parts_
+		  ? count
+		  : count / this->parts_ * (part + 1));
+    if (begin == 0)
+      {
+	if (count > 0)
+	  (*this->is_suffix_)[0] = 0;
+	begin = 1;
+      }
+    for (size_t i = begin; i < end; ++i)
+      {
+	const Hashkey& curr(this->v_[i]->first);
+	const Hashkey& last(this->v_[i - 1]->first);
+	(*this->is_suffix_)[i] = Stringpool_template::is_suffix(curr.string,
+								curr.length,
+								last.string,
+								last.length);
+      }
+  }
+
+ private:
+  const std::vector<Stringpool_sort_info>& v_;
+  std::vector<unsigned char>* is_suffix_;
+  unsigned int parts_;
+};
+
 // Turn the stringpool into an ELF strtab: determine the offsets of
 // each string in the table.
 
@@ -400,7 +474,18 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
            ++p)
         v.push_back(Stringpool_sort_info(p));
 
-      std::sort(v.begin(), v.end(), Stringpool_sort_comparison());
+      // The sort and the suffix comparisons are the expensive part,
+      // so do them on all the threads.  Only the offset assignment,
+      // which depends on the preceding strings, is done serially.
+      parallel_sort(v.begin(), v.end(), Stringpool_sort_comparison());
+
+      std::vector<unsigned char> suffix_flags(count);
+      unsigned int parts = std::max(1U,
+				    std::min(Workqueue::parallel_thread_count(),
+					     static_cast<unsigned int>(count
+								       / 8192)));
+      Suffix_finder finder(v, &suffix_flags, parts);
+      Workqueue::run_in_parallel(&finder, parts);
 
       section_offset_type last_offset = -1;
       for (typename std::vector<Stringpool_sort_info>::iterator last = v.end(),
@@ -411,11 +496,7 @@ Stringpool_template<Stringpool_char>::set_string_offsets()
 	  section_offset_type this_offset;
           if (this->zero_null_ && (*curr)->first.string[0] == 0)
             this_offset = 0;
-          else if (last != v.end()
-                   && is_suffix((*curr)->first.string,
-				(*curr)->first.length,
-                                (*last)->first.string,
-				(*last)->first.length))
+          else if (last != v.end() && suffix_flags[curr - v.begin()])
             this_offset = (last_offset
 			   + (((*last)->first.length - (*curr)->first.length)
 			      * charsize));
@@ -224,6 +224,13 @@ class Stringpool_template
   const Stringpool_char*
   add_with_length(const Stringpool_char* s, size_t len, bool copy, Key* pkey);
 
+  // Add string S of length LEN characters to the pool, where
+  // HASH_CODE is the value of gold::string_hash for S.  This lets
+  // callers compute hash codes ahead of time, perhaps in parallel.
+  const Stringpool_char*
+  add_with_hash(const Stringpool_char* s, size_t len, size_t hash_code,
+		bool copy, Key* pkey);
+
   // If the string S is present in the pool, return the canonical
   // string pointer.  Otherwise, return NULL.  If PKEY is not NULL,
   // set *PKEY to the key.
@@ -348,6 +355,11 @@ class Stringpool_template
     Hashkey(const Stringpool_char* s, size_t len)
       : string(s), length(len), hash_code(string_hash(s, len))
     { }
+
+    // Use a hash code which the caller has already computed.
+    Hashkey(const Stringpool_char* s, size_t len, size_t hash)
+      : string(s), length(len), hash_code(hash)
+    { }
   };
 
   // Hash function.  This is trivial, since we have already computed
@@ -366,6 +378,10 @@ class Stringpool_template
     operator()(const Hashkey&, const Hashkey&) const;
   };
 
+  // Add the string described by a Hashkey to the pool.
+  const Stringpool_char*
+  add_hashkey(const Hashkey&, bool copy, Key* pkey);
+
   // The hash table is a map from strings to Keys.
 
   typedef Key Hashval;
@@ -383,6 +399,10 @@ class Stringpool_template
     operator()(const Stringpool_sort_info&, const Stringpool_sort_info&) const;
   };
 
+  // A Parallel_runner used by set_string_offsets to find the strings
+  // which are suffixes of the preceding string in sorted order.
+  class Suffix_finder;
+
   // Keys map to offsets via a Chunked_vector.  We only use the
   // offsets if we turn this into an string table section.
   typedef Chunked_vector<section_offset_type> Key_to_offset;
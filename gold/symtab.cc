@@ -47,8 +47,8 @@ namespace gold
 
 // Class Symbol.
 
-// Initialize fields in Symbol.  This initializes everything except u_
-// and source_.
+// Initialize fields in Symbol.  This initializes everything except
+// u1_, u2_ and source_.
 
 void
 Symbol::init_fields(const char* name, const char* version,
@@ -118,8 +118,8 @@ Symbol::init_base_object(const char* name, const char* version, Object* object,
 {
   this->init_fields(name, version, sym.get_st_type(), sym.get_st_bind(),
 		    sym.get_st_visibility(), sym.get_st_nonvis());
-  this->u_.from_object.object = object;
-  this->u_.from_object.shndx = st_shndx;
+  this->u1_.object = object;
+  this->u2_.shndx = st_shndx;
   this->is_ordinary_shndx_ = is_ordinary;
   this->source_ = FROM_OBJECT;
   this->in_reg_ = !object->is_dynamic();
@@ -138,8 +138,8 @@ Symbol::init_base_output_data(const char* name, const char* version,
 			      bool is_predefined)
 {
   this->init_fields(name, version, type, binding, visibility, nonvis);
-  this->u_.in_output_data.output_data = od;
-  this->u_.in_output_data.offset_is_from_end = offset_is_from_end;
+  this->u1_.output_data = od;
+  this->u2_.offset_is_from_end = offset_is_from_end;
   this->source_ = IN_OUTPUT_DATA;
   this->in_reg_ = true;
   this->in_real_elf_ = true;
@@ -158,8 +158,8 @@ Symbol::init_base_output_segment(const char* name, const char* version,
 				 bool is_predefined)
 {
   this->init_fields(name, version, type, binding, visibility, nonvis);
-  this->u_.in_output_segment.output_segment = os;
-  this->u_.in_output_segment.offset_base = offset_base;
+  this->u1_.output_segment = os;
+  this->u2_.offset_base = offset_base;
   this->source_ = IN_OUTPUT_SEGMENT;
   this->in_reg_ = true;
   this->in_real_elf_ = true;
@@ -204,8 +204,8 @@ Symbol::allocate_base_common(Output_data* od)
 {
   gold_assert(this->is_common());
   this->source_ = IN_OUTPUT_DATA;
-  this->u_.in_output_data.output_data = od;
-  this->u_.in_output_data.offset_is_from_end = false;
+  this->u1_.output_data = od;
+  this->u2_.offset_is_from_end = false;
 }
 
 // Initialize the fields in Sized_symbol for SYM in OBJECT.
@@ -448,19 +448,19 @@ Symbol::output_section() const
     {
     case FROM_OBJECT:
       {
-	unsigned int shndx = this->u_.from_object.shndx;
+	unsigned int shndx = this->u2_.shndx;
 	if (shndx != elfcpp::SHN_UNDEF && this->is_ordinary_shndx_)
 	  {
-	    gold_assert(!this->u_.from_object.object->is_dynamic());
-	    gold_assert(this->u_.from_object.object->pluginobj() == NULL);
-	    Relobj* relobj = static_cast<Relobj*>(this->u_.from_object.object);
+	    gold_assert(!this->u1_.object->is_dynamic());
+	    gold_assert(this->u1_.object->pluginobj() == NULL);
+	    Relobj* relobj = static_cast<Relobj*>(this->u1_.object);
 	    return relobj->output_section(shndx);
 	  }
 	return NULL;
       }
 
     case IN_OUTPUT_DATA:
-      return this->u_.in_output_data.output_data->output_section();
+      return this->u1_.output_data->output_section();
 
     case IN_OUTPUT_SEGMENT:
     case IS_CONSTANT:
@@ -487,8 +487,8 @@ Symbol::set_output_section(Output_section* os)
       break;
     case IS_CONSTANT:
       this->source_ = IN_OUTPUT_DATA;
-      this->u_.in_output_data.output_data = os;
-      this->u_.in_output_data.offset_is_from_end = false;
+      this->u1_.output_data = os;
+      this->u2_.offset_is_from_end = false;
       break;
     case IN_OUTPUT_SEGMENT:
     case IS_UNDEFINED:
@@ -502,7 +502,9 @@ Symbol::set_output_section(Output_section* os)
 Symbol_table::Symbol_table(unsigned int count,
                            const Version_script_info& version_script)
   : saw_undefined_(0), offset_(0), table_(count), namepool_(),
-    forwarders_(), commons_(), tls_commons_(), small_commons_(),
+    forwarders_(), weak_aliases_(), symbol_block_(NULL),
+    symbol_block_remaining_(0), block_symbol_count_(0),
+    block_symbol_bytes_(0), commons_(), tls_commons_(), small_commons_(),
     large_commons_(), forced_locals_(), warnings_(),
     version_script_(version_script), gc_(NULL), icf_(NULL)
 {
@@ -974,7 +976,7 @@ Symbol_table::add_from_object(Object* object,
 	  Sized_target<size, big_endian>* target =
 	    parameters->sized_target<size, big_endian>();
 	  if (!target->has_make_symbol())
-	    ret = new Sized_symbol<size>();
+	    ret = this->allocate_symbol<size>();
 	  else
 	    {
 	      ret = target->make_symbol();
@@ -1045,6 +1047,35 @@ Symbol_table::add_from_object(Object* object,
   return ret;
 }
 
+// Describe the name of an external symbol in a relocatable object.
+// In an object file, an '@' in the name separates the symbol name
+// from the version name.  If there are two '@' characters, this is
+// the default version.
+
+void
+Symbol_table::get_symbol_name_info(const char* name, Symbol_name_info* info)
+{
+  const char* ver = strchr(name, '@');
+  info->is_default_version = false;
+  if (ver == NULL)
+    {
+      info->name_length = strlen(name);
+      info->version_offset = 0;
+    }
+  else
+    {
+      info->name_length = ver - name;
+      ++ver;
+      if (*ver == '@')
+	{
+	  info->is_default_version = true;
+	  ++ver;
+	}
+      info->version_offset = ver - name;
+    }
+  info->hash_code = string_hash<char>(name, info->name_length);
+}
+
 // Add all the symbols in a relocatable object to the hash table.
 
 template<int size, bool big_endian>
@@ -1056,6 +1087,7 @@ Symbol_table::add_from_relobj(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_info* name_info,
     typename Sized_relobj_file<size, big_endian>::Symbols* sympointers,
     size_t* defined)
 {
@@ -1107,35 +1139,36 @@ Symbol_table::add_from_relobj(
 	  is_defined_in_discarded_section = true;
 	}
 
-      // In an object file, an '@' in the name separates the symbol
-      // name from the version name.  If there are two '@' characters,
-      // this is the default version.
-      const char* ver = strchr(name, '@');
+      // Split the name into the symbol name and the version name.
+      // Normally read_symbols has already done this for us.
+      Symbol_name_info local_name_info;
+      const Symbol_name_info* pinfo;
+      if (name_info != NULL)
+	pinfo = &name_info[i];
+      else
+	{
+	  get_symbol_name_info(name, &local_name_info);
+	  pinfo = &local_name_info;
+	}
+
+      const char* ver = NULL;
       Stringpool::Key ver_key = 0;
-      int namelen = 0;
       // IS_DEFAULT_VERSION: is the version default?
       // IS_FORCED_LOCAL: is the symbol forced local?
-      bool is_default_version = false;
+      bool is_default_version = pinfo->is_default_version;
       bool is_forced_local = false;
 
-      if (ver != NULL)
+      if (pinfo->version_offset != 0)
         {
           // The symbol name is of the form foo@VERSION or foo@@VERSION
-          namelen = ver - name;
-          ++ver;
-	  if (*ver == '@')
-	    {
-	      is_default_version = true;
-	      ++ver;
-	    }
-	  ver = this->namepool_.add(ver, true, &ver_key);
+	  ver = this->namepool_.add(name + pinfo->version_offset, true,
+				    &ver_key);
         }
       // We don't want to assign a version to an undefined symbol,
       // even if it is listed in the version script.  FIXME: What
       // about a common symbol?
       else
 	{
-	  namelen = strlen(name);
 	  if (!this->version_script_.empty()
 	      && st_shndx != elfcpp::SHN_UNDEF)
 	    {
@@ -1207,8 +1240,8 @@ Symbol_table::add_from_relobj(
         }
 
       Stringpool::Key name_key;
-      name = this->namepool_.add_with_length(name, namelen, true,
-					     &name_key);
+      name = this->namepool_.add_with_hash(name, pinfo->name_length,
+					   pinfo->hash_code, true, &name_key);
 
       Sized_symbol<size>* res;
       res = this->add_from_object(relobj, name, name_key, ver, ver_key,
@@ -3037,6 +3070,32 @@ Symbol_table::sized_write_section_symbol(const Output_section* os,
   of->write_output_view(offset, sym_size, pov);
 }
 
+// Allocate a new symbol.  Most symbols come from input files and are
+// never freed, so we carve them out of large blocks.
+
+template<int size>
+Sized_symbol<size>*
+Symbol_table::allocate_symbol()
+{
+  // The number of symbols in each block.
+  const size_t symbol_block_count = 1024;
+
+  if (this->symbol_block_remaining_ == 0)
+    {
+      this->symbol_block_ = new Sized_symbol<size>[symbol_block_count];
+      this->symbol_block_remaining_ = symbol_block_count;
+      this->block_symbol_bytes_ += (symbol_block_count
+				    * sizeof(Sized_symbol<size>));
+    }
+
+  Sized_symbol<size>* ret =
+    static_cast<Sized_symbol<size>*>(this->symbol_block_);
+  this->symbol_block_ = ret + 1;
+  --this->symbol_block_remaining_;
+  ++this->block_symbol_count_;
+  return ret;
+}
+
 // Print statistical information to stderr.  This is used for --stats.
 
 void
@@ -3049,6 +3108,12 @@ Symbol_table::print_stats() const
   fprintf(stderr, _("%s: symbol table entries: %zu\n"),
 	  program_name, this->table_.size());
 #endif
+  if (this->block_symbol_count_ > 0)
+    fprintf(stderr,
+	    _("%s: symbols allocated: %zu; bytes: %zu; bytes per symbol: %zu\n"),
+	    program_name, this->block_symbol_count_,
+	    this->block_symbol_bytes_,
+	    this->block_symbol_bytes_ / this->block_symbol_count_);
   this->namepool_.print_stats("symbol table stringpool");
 }
 
@@ -3063,7 +3128,7 @@ Symbol_table::print_stats() const
 // in those cases.
 
 // This struct is used to compare line information, as returned by
-// Dwarf_line_info::one_addr2line.  It implements a < comparison
+// Dwarf_line_info::addr2line.  It implements a < comparison
 // operator used with std::sort.
 
 struct Odr_violation_compare
@@ -3090,27 +3155,97 @@ struct Odr_violation_compare
 // Returns all of the lines attached to LOC, not just the one the
 // instruction actually came from.
 std::vector<std::string>
-Symbol_table::linenos_from_loc(const Task* task,
+Symbol_table::linenos_from_loc(const Odr_line_infos& line_infos,
                                const Symbol_location& loc)
 {
-  // We need to lock the object in order to read it.  This
-  // means that we have to run in a singleton Task.  If we
-  // want to run this in a general Task for better
-  // performance, we will need one Task for object, plus
-  // appropriate locking to ensure that we don't conflict with
-  // other uses of the object.  Also note, one_addr2line is not
-  // currently thread-safe.
-  Task_lock_obj<Object> tl(task, loc.object);
+  Odr_line_infos::const_iterator p = line_infos.find(loc.object);
+  gold_assert(p != line_infos.end());
 
   std::vector<std::string> result;
-  // 16 is the size of the object-cache that one_addr2line should use.
-  std::string canonical_result = Dwarf_line_info::one_addr2line(
-      loc.object, loc.shndx, loc.offset, 16, &result);
+  std::string canonical_result = p->second->addr2line(loc.shndx, loc.offset,
+						      &result);
   if (!canonical_result.empty())
     result.push_back(canonical_result);
   return result;
 }
 
+// Decode the line information of some objects on several threads.
+// The readers have already copied what they need from the objects,
+// so the objects need not be locked.
+
+class Odr_line_decoder : public Parallel_runner
+{
+ public:
+  Odr_line_decoder(const std::vector<Dwarf_line_info*>& line_infos)
+    : line_infos_(line_infos)
+  { }
+
+  void
+  run(unsigned int part)
+  { this->line_infos_[part]->decode(); }
+
+ private:
+  const std::vector<Dwarf_line_info*>& line_infos_;
+};
+
+// Read the line information for the definitions of the symbols in
+// candidate_odr_violations_.  Each object's .debug_line section is
+// read once, keeping only the sections we will look up.  We must
+// lock an object to read it, which we do one at a time on this
+// thread, but the decoding is done in parallel.  To limit the memory
+// used by the copies of the sections, we decode in batches.
+
+void
+Symbol_table::read_odr_line_infos(const Task* task,
+				  Odr_line_infos* line_infos) const
+{
+  Unordered_map<Object*, std::vector<unsigned int> > object_shndxs;
+  for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
+       it != candidate_odr_violations_.end();
+       ++it)
+    {
+      // With only one definition there is nothing to compare.
+      if (it->second.size() < 2)
+	continue;
+      for (Unordered_set<Symbol_location, Symbol_location_hash>::const_iterator
+	     p = it->second.begin();
+	   p != it->second.end();
+	   ++p)
+	object_shndxs[p->object].push_back(p->shndx);
+    }
+
+  const size_t batch_size = 64;
+  std::vector<Dwarf_line_info*> batch;
+  batch.reserve(batch_size);
+  for (Unordered_map<Object*, std::vector<unsigned int> >::iterator p =
+	 object_shndxs.begin();
+       p != object_shndxs.end();
+       ++p)
+    {
+      std::vector<unsigned int>& shndxs(p->second);
+      std::sort(shndxs.begin(), shndxs.end());
+      shndxs.erase(std::unique(shndxs.begin(), shndxs.end()), shndxs.end());
+
+      Dwarf_line_info* line_info;
+      {
+	Task_lock_obj<Object> tl(task, p->first);
+	line_info = Dwarf_line_info::create_deferred(p->first, shndxs);
+      }
+      (*line_infos)[p->first] = line_info;
+
+      batch.push_back(line_info);
+      if (batch.size() == batch_size)
+	{
+	  Odr_line_decoder decoder(batch);
+	  Workqueue::run_in_parallel(&decoder, batch.size());
+	  batch.clear();
+	}
+    }
+
+  Odr_line_decoder decoder(batch);
+  Workqueue::run_in_parallel(&decoder, batch.size());
+}
+
 // OutputIterator that records if it was ever assigned to.  This
 // allows it to be used with std::set_intersection() to check for
 // intersection rather than computing the intersection.
@@ -3148,10 +3283,17 @@ void
 Symbol_table::detect_odr_violations(const Task* task,
 				    const char* output_file_name) const
 {
+  Odr_line_infos line_infos;
+  this->read_odr_line_infos(task, &line_infos);
+
   for (Odr_map::const_iterator it = candidate_odr_violations_.begin();
        it != candidate_odr_violations_.end();
        ++it)
     {
+      // read_odr_line_infos skips a symbol with only one definition.
+      if (it->second.size() < 2)
+	continue;
+
       const char* const symbol_name = it->first;
 
       std::string first_object_name;
@@ -3170,7 +3312,7 @@ Symbol_table::detect_odr_violations(const Task* task,
           // false negatives that appear or disappear depending on the
           // link order, but it won't cause false positives.
           first_object_name = locs->object->name();
-          first_object_linenos = this->linenos_from_loc(task, *locs);
+          first_object_linenos = this->linenos_from_loc(line_infos, *locs);
         }
 
       // Sort by Odr_violation_compare to make std::set_intersection work.
@@ -3180,7 +3322,7 @@ Symbol_table::detect_odr_violations(const Task* task,
       for (; locs != locs_end; ++locs)
         {
           std::vector<std::string> linenos =
-              this->linenos_from_loc(task, *locs);
+              this->linenos_from_loc(line_infos, *locs);
           // linenos will be empty if we couldn't parse the debug info.
           if (linenos.empty())
             continue;
@@ -3221,8 +3363,11 @@ Symbol_table::detect_odr_violations(const Task* task,
             }
         }
     }
-  // We only call one_addr2line() in this function, so we can clear its cache.
-  Dwarf_line_info::clear_addr2line_cache();
+
+  for (Odr_line_infos::iterator p = line_infos.begin();
+       p != line_infos.end();
+       ++p)
+    delete p->second;
 }
 
 // Warnings functions.
@@ -3298,6 +3443,7 @@ Symbol_table::add_from_relobj<32, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_info* name_info,
     Sized_relobj_file<32, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3312,6 +3458,7 @@ Symbol_table::add_from_relobj<32, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_info* name_info,
     Sized_relobj_file<32, true>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3326,6 +3473,7 @@ Symbol_table::add_from_relobj<64, false>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_info* name_info,
     Sized_relobj_file<64, false>::Symbols* sympointers,
     size_t* defined);
 #endif
@@ -3340,6 +3488,7 @@ Symbol_table::add_from_relobj<64, true>(
     size_t symndx_offset,
     const char* sym_names,
     size_t sym_name_size,
+    const Symbol_name_info* name_info,
     Sized_relobj_file<64, true>::Symbols* sympointers,
     size_t* defined);
 #endif
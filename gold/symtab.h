@@ -53,6 +53,7 @@ class Sized_incrobj;
 class Versions;
 class Version_script_info;
 class Input_objects;
+class Dwarf_line_info;
 class Output_data;
 class Output_section;
 class Output_segment;
@@ -146,7 +147,7 @@ class Symbol
   object() const
   {
     gold_assert(this->source_ == FROM_OBJECT);
-    return this->u_.from_object.object;
+    return this->u1_.object;
   }
 
   // Return the index of the section in the input relocatable or
@@ -156,7 +157,7 @@ class Symbol
   {
     gold_assert(this->source_ == FROM_OBJECT);
     *is_ordinary = this->is_ordinary_shndx_;
-    return this->u_.from_object.shndx;
+    return this->u2_.shndx;
   }
 
   // Return the output data section with which this symbol is
@@ -166,7 +167,7 @@ class Symbol
   output_data() const
   {
     gold_assert(this->source_ == IN_OUTPUT_DATA);
-    return this->u_.in_output_data.output_data;
+    return this->u1_.output_data;
   }
 
   // If this symbol was defined with respect to an output data
@@ -175,7 +176,7 @@ class Symbol
   offset_is_from_end() const
   {
     gold_assert(this->source_ == IN_OUTPUT_DATA);
-    return this->u_.in_output_data.offset_is_from_end;
+    return this->u2_.offset_is_from_end;
   }
 
   // Return the output segment with which this symbol is associated,
@@ -185,7 +186,7 @@ class Symbol
   output_segment() const
   {
     gold_assert(this->source_ == IN_OUTPUT_SEGMENT);
-    return this->u_.in_output_segment.output_segment;
+    return this->u1_.output_segment;
   }
 
   // If this symbol was defined with respect to an output segment,
@@ -194,7 +195,7 @@ class Symbol
   offset_base() const
   {
     gold_assert(this->source_ == IN_OUTPUT_SEGMENT);
-    return this->u_.in_output_segment.offset_base;
+    return this->u2_.offset_base;
   }
 
   // Return the symbol binding.
@@ -886,40 +887,44 @@ class Symbol
   // be NULL.
   const char* version_;
 
+  // The source specific parts of the symbol are split into two
+  // unions, one of pointers and one of small values, so that they pack
+  // without padding.
+
   union
   {
-    // This struct is used if SOURCE_ == FROM_OBJECT.
-    struct
-    {
-      // Object in which symbol is defined, or in which it was first
-      // seen.
-      Object* object;
-      // Section number in object_ in which symbol is defined.
-      unsigned int shndx;
-    } from_object;
-
-    // This struct is used if SOURCE_ == IN_OUTPUT_DATA.
-    struct
-    {
-      // Output_data in which symbol is defined.  Before
-      // Layout::finalize the symbol's value is an offset within the
-      // Output_data.
-      Output_data* output_data;
-      // True if the offset is from the end, false if the offset is
-      // from the beginning.
-      bool offset_is_from_end;
-    } in_output_data;
-
-    // This struct is used if SOURCE_ == IN_OUTPUT_SEGMENT.
-    struct
-    {
-      // Output_segment in which the symbol is defined.  Before
-      // Layout::finalize the symbol's value is an offset.
-      Output_segment* output_segment;
-      // The base to use for the offset before Layout::finalize.
-      Segment_offset_base offset_base;
-    } in_output_segment;
-  } u_;
+    // This is used if SOURCE_ == FROM_OBJECT.
+    // Object in which symbol is defined, or in which it was first
+    // seen.
+    Object* object;
+
+    // This is used if SOURCE_ == IN_OUTPUT_DATA.
+    // Output_data in which symbol is defined.  Before
+    // Layout::finalize the symbol's value is an offset within the
+    // Output_data.
+    Output_data* output_data;
+
+    // This is used if SOURCE_ == IN_OUTPUT_SEGMENT.
+    // Output_segment in which the symbol is defined.  Before
+    // Layout::finalize the symbol's value is an offset.
+    Output_segment* output_segment;
+  } u1_;
+
+  union
+  {
+    // This is used if SOURCE_ == FROM_OBJECT.
+    // Section number in object in which symbol is defined.
+    unsigned int shndx;
+
+    // This is used if SOURCE_ == IN_OUTPUT_DATA.
+    // True if the offset is from the end, false if the offset is
+    // from the beginning.
+    bool offset_is_from_end;
+
+    // This is used if SOURCE_ == IN_OUTPUT_SEGMENT.
+    // The base to use for the offset before Layout::finalize.
+    Segment_offset_base offset_base;
+  } u2_;
 
   // The index of this symbol in the output file.  If the symbol is
   // not going into the output file, this value is -1U.  This field
@@ -933,16 +938,16 @@ class Symbol
   // non-zero value during Layout::finalize.
   unsigned int dynsym_index_;
 
-  // The GOT section entries for this symbol.  A symbol may have more
-  // than one GOT offset (e.g., when mixing modules compiled with two
-  // different TLS models), but will usually have at most one.
-  Got_offset_list got_offsets_;
-
   // If this symbol has an entry in the PLT section, then this is the
   // offset from the start of the PLT section.  This is -1U if there
   // is no PLT entry.
   unsigned int plt_offset_;
 
+  // The GOT section entries for this symbol.  A symbol may have more
+  // than one GOT offset (e.g., when mixing modules compiled with two
+  // different TLS models), but will usually have at most one.
+  Got_offset_list got_offsets_;
+
   // Symbol type (bits 0 to 3).
   elfcpp::STT type_ : 4;
   // Symbol binding (bits 4 to 7).
@@ -984,7 +989,7 @@ class Symbol
   // True if this symbol was forced to local visibility by a version
   // script (bit 28).
   bool is_forced_local_ : 1;
-  // True if the field u_.from_object.shndx is an ordinary section
+  // True if the field u2_.shndx is an ordinary section
   // index, not one of the special codes from SHN_LORESERVE to
   // SHN_HIRESERVE (bit 29).
   bool is_ordinary_shndx_ : 1;
@@ -1313,18 +1318,25 @@ class Symbol_table
   inline void
   gc_mark_dyn_syms(Symbol* sym);
 
+  // Set *INFO to describe NAME, the name of an external symbol in a
+  // relocatable object.  This only looks at NAME, so it may be called
+  // from any thread.
+  static void
+  get_symbol_name_info(const char* name, Symbol_name_info* info);
+
   // Add COUNT external symbols from the relocatable object RELOBJ to
   // the symbol table.  SYMS is the symbols, SYMNDX_OFFSET is the
   // offset in the symbol table of the first symbol, SYM_NAMES is
-  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  This sets
-  // SYMPOINTERS to point to the symbols in the symbol table.  It sets
-  // *DEFINED to the number of defined symbols.
+  // their names, SYM_NAME_SIZE is the size of SYM_NAMES.  NAME_INFO,
+  // if not NULL, is the result of get_symbol_name_info for each
+  // symbol.  This sets SYMPOINTERS to point to the symbols in the
+  // symbol table.  It sets *DEFINED to the number of defined symbols.
   template<int size, bool big_endian>
   void
   add_from_relobj(Sized_relobj_file<size, big_endian>* relobj,
 		  const unsigned char* syms, size_t count,
 		  size_t symndx_offset, const char* sym_names,
-		  size_t sym_name_size,
+		  size_t sym_name_size, const Symbol_name_info* name_info,
 		  typename Sized_relobj_file<size, big_endian>::Symbols*,
 		  size_t* defined);
 
@@ -1613,6 +1625,10 @@ class Symbol_table
                         Unordered_set<Symbol_location, Symbol_location_hash> >
   Odr_map;
 
+  // The line information of each object with a candidate ODR
+  // violation.
+  typedef Unordered_map<const Object*, Dwarf_line_info*> Odr_line_infos;
+
   // Make FROM a forwarder symbol to TO.
   void
   make_forwarder(Symbol* from, Symbol* to);
@@ -1688,6 +1704,11 @@ class Symbol_table
   void
   record_weak_aliases(std::vector<Sized_symbol<size>*>*);
 
+  // Allocate a new symbol from the current block of symbols.
+  template<int size>
+  Sized_symbol<size>*
+  allocate_symbol();
+
   // Define a special symbol.
   template<int size, bool big_endian>
   Sized_symbol<size>*
@@ -1764,7 +1785,12 @@ class Symbol_table
   // instruction actually came from.  This helps the ODR checker avoid
   // false positives.
   static std::vector<std::string>
-  linenos_from_loc(const Task* task, const Symbol_location& loc);
+  linenos_from_loc(const Odr_line_infos&, const Symbol_location& loc);
+
+  // Read the line information detect_odr_violations needs into
+  // LINE_INFOS.
+  void
+  read_odr_line_infos(const Task*, Odr_line_infos* line_infos) const;
 
   // Implement detect_odr_violations.
   template<int size, bool big_endian>
@@ -1845,6 +1871,16 @@ class Symbol_table
   // Weak aliases.  A symbol in this list points to the next alias.
   // The aliases point to each other in a circular list.
   Unordered_map<Symbol*, Symbol*> weak_aliases_;
+  // Symbols read from input files are allocated in blocks, to avoid
+  // the overhead of a separate heap allocation for each one.  This is
+  // the next free symbol in the current block, and the number of free
+  // symbols left in it.  The blocks are never freed.
+  Symbol* symbol_block_;
+  size_t symbol_block_remaining_;
+  // The number of symbols allocated from blocks, and the number of
+  // bytes in the blocks, for --stats.
+  size_t block_symbol_count_;
+  size_t block_symbol_bytes_;
   // We don't expect there to be very many common symbols, so we keep
   // a list of them.  When we find a common symbol we add it to this
   // list.  It is possible that by the time we process the list the
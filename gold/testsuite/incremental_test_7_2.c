@@ -0,0 +1,26 @@
+/* incremental_test_7_2.c -- incremental link with a globals-free object
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of gold.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.
+
+   This object has only static data and therefore no global symbols.
+   An incremental link must still allocate its (empty) incremental
+   relocation tables.  */
+
+__attribute__((used)) static int data[4] = { 1, 2, 3, 4 };
@@ -0,0 +1,784 @@
+// reloc_bench.cc -- benchmark relocation processing in gold.
+
+// Copyright 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This program writes relocatable objects for a target with a given
+// number and mix of relocations, links them with the linker being
+// tested at several thread counts, and reports the number of
+// relocations processed per second.  To separate the relocation work
+// from the rest of the link, each link is compared with a link of the
+// same objects with the relocation sections left out.  The objects
+// are written directly, so no assembler for the target is needed.
+
+// This is not run by "make check".  Run "make bench" in the testsuite
+// build directory, or run reloc_bench --help for the options.
+
+#include "config.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include "elfcpp.h"
+#include "arm.h"
+#include "i386.h"
+#include "x86_64.h"
+
+namespace
+{
+
+// What a relocation refers to.
+
+enum Reloc_target
+{
+  // A global function defined in another object.
+  TARGET_FUNCTION,
+  // Alternately a global data symbol defined in another object, and
+  // the local .data section symbol with an addend.
+  TARGET_DATA,
+  // A global data symbol defined in another object.
+  TARGET_GLOBAL_DATA
+};
+
+// A kind of relocation which the benchmark can generate.
+
+struct Reloc_kind
+{
+  // The name used in --mix.
+  const char* name;
+  // The relocation type.
+  unsigned int r_type;
+  // The size of the field, which is also its alignment.
+  unsigned int size;
+  // The initial contents of the field, in target byte order.  For
+  // REL targets this holds the addend.
+  unsigned char contents[8];
+  // What the relocation refers to.
+  Reloc_target target;
+};
+
+// A target which the benchmark supports.
+
+struct Target_desc
+{
+  // The name used in --target.
+  const char* name;
+  // 32 or 64.
+  int size;
+  // The ELF machine number.
+  unsigned int machine;
+  // The ELF header flags.
+  unsigned int flags;
+  // Whether the target uses SHT_RELA rather than SHT_REL.
+  bool is_rela;
+  // The mix of relocations used if --mix is not given.
+  const char* default_mix;
+  // The relocations we can generate, ending with a NULL name.
+  const Reloc_kind* kinds;
+};
+
+const Reloc_kind x86_64_kinds[] =
+{
+  { "abs64", elfcpp::R_X86_64_64, 8, { 0 }, TARGET_DATA },
+  { "abs32s", elfcpp::R_X86_64_32S, 4, { 0 }, TARGET_DATA },
+  { "pc32", elfcpp::R_X86_64_PC32, 4, { 0 }, TARGET_DATA },
+  { "plt32", elfcpp::R_X86_64_PLT32, 4, { 0 }, TARGET_FUNCTION },
+  { "gotpcrel", elfcpp::R_X86_64_GOTPCREL, 4, { 0 }, TARGET_GLOBAL_DATA },
+  { NULL, 0, 0, { 0 }, TARGET_DATA }
+};
+
+const Reloc_kind i386_kinds[] =
+{
+  { "abs32", elfcpp::R_386_32, 4, { 0 }, TARGET_DATA },
+  { "pc32", elfcpp::R_386_PC32, 4, { 0 }, TARGET_DATA },
+  { "plt32", elfcpp::R_386_PLT32, 4, { 0 }, TARGET_FUNCTION },
+  { "gotoff", elfcpp::R_386_GOTOFF, 4, { 0 }, TARGET_DATA },
+  { NULL, 0, 0, { 0 }, TARGET_DATA }
+};
+
+// The ARM contents are little-endian instructions with the usual
+// assembler addends.
+
+const Reloc_kind arm_kinds[] =
+{
+  { "abs32", elfcpp::R_ARM_ABS32, 4, { 0 }, TARGET_DATA },
+  { "rel32", elfcpp::R_ARM_REL32, 4, { 0 }, TARGET_DATA },
+  // bl .
+  { "call", elfcpp::R_ARM_CALL, 4, { 0xfe, 0xff, 0xff, 0xeb },
+    TARGET_FUNCTION },
+  // b .
+  { "jump24", elfcpp::R_ARM_JUMP24, 4, { 0xfe, 0xff, 0xff, 0xea },
+    TARGET_FUNCTION },
+  // movw r0, #0
+  { "movw", elfcpp::R_ARM_MOVW_ABS_NC, 4, { 0x00, 0x00, 0x00, 0xe3 },
+    TARGET_DATA },
+  // movt r0, #0
+  { "movt", elfcpp::R_ARM_MOVT_ABS, 4, { 0x00, 0x00, 0x40, 0xe3 },
+    TARGET_DATA },
+  // Thumb-2 bl .
+  { "thm_call", elfcpp::R_ARM_THM_CALL, 4, { 0xff, 0xf7, 0xfe, 0xff },
+    TARGET_FUNCTION },
+  { NULL, 0, 0, { 0 }, TARGET_DATA }
+};
+
+const Target_desc targets[] =
+{
+  { "x86_64", 64, elfcpp::EM_X86_64, 0, true,
+    "abs64:2,pc32:4,plt32:4,gotpcrel:1", x86_64_kinds },
+  { "i386", 32, elfcpp::EM_386, 0, false,
+    "abs32:2,pc32:4,plt32:4,gotoff:1", i386_kinds },
+  { "arm", 32, elfcpp::EM_ARM, elfcpp::EF_ARM_EABI_VER5, false,
+    "abs32:2,call:4,jump24:1,movw:1,movt:1", arm_kinds },
+};
+
+const unsigned int target_count = sizeof targets / sizeof targets[0];
+
+// The number of global functions defined by each object.
+const unsigned int function_count = 64;
+
+// The size of the .data section of each object.
+const unsigned int data_size = 4096;
+
+// The options.
+
+struct Options
+{
+  const char* linker;
+  std::string target;
+  unsigned int relocs;
+  unsigned int objects;
+  std::vector<unsigned int> threads;
+  std::string mix;
+  unsigned int repeat;
+  std::string dir;
+
+  Options()
+    : linker("../ld-new"), target("all"), relocs(1000000), objects(64),
+      threads(), mix(), repeat(3), dir("reloc_bench.dir")
+  { }
+};
+
+void
+usage(FILE* f)
+{
+  fprintf(f,
+	  "Usage: reloc_bench [options]\n"
+	  "  --linker=LD        Linker to run (default ../ld-new)\n"
+	  "  --target=NAME      x86_64, i386, arm, or all (default all)\n"
+	  "  --relocs=N         Total number of relocations (default 1000000)\n"
+	  "  --objects=N        Number of objects to split them into "
+	  "(default 64)\n"
+	  "  --threads=N,...    Thread counts to link with (default 1,2,4)\n"
+	  "  --mix=KIND:W,...   Relocation kinds and relative weights\n"
+	  "  --repeat=N         Links per measurement; the fastest is used "
+	  "(default 3)\n"
+	  "  --dir=DIR          Directory for the generated files\n"
+	  "                     (default reloc_bench.dir)\n");
+  for (unsigned int i = 0; i < target_count; ++i)
+    {
+      fprintf(f, "Relocation kinds for %s:", targets[i].name);
+      for (const Reloc_kind* k = targets[i].kinds; k->name != NULL; ++k)
+	fprintf(f, " %s", k->name);
+      fprintf(f, "\n  default --mix=%s\n", targets[i].default_mix);
+    }
+}
+
+// Parse an unsigned number, exiting on error.
+
+unsigned int
+parse_number(const char* option, const char* arg)
+{
+  char* end;
+  unsigned long val = strtoul(arg, &end, 10);
+  if (*arg == '\0' || *end != '\0' || val == 0)
+    {
+      fprintf(stderr, "reloc_bench: bad value for %s: %s\n", option, arg);
+      exit(EXIT_FAILURE);
+    }
+  return val;
+}
+
+// Split S at commas.
+
+std::vector<std::string>
+split(const std::string& s)
+{
+  std::vector<std::string> ret;
+  std::string::size_type start = 0;
+  while (true)
+    {
+      std::string::size_type comma = s.find(',', start);
+      ret.push_back(s.substr(start, comma - start));
+      if (comma == std::string::npos)
+	break;
+      start = comma + 1;
+    }
+  return ret;
+}
+
+// Turn a --mix string for TARGET into the repeating pattern of
+// relocation kinds to generate.  Return false if it is not valid.
+
+bool
+parse_mix(const Target_desc& target, const std::string& mix,
+	  std::vector<const Reloc_kind*>* pattern)
+{
+  std::vector<std::string> parts(split(mix));
+  for (size_t i = 0; i < parts.size(); ++i)
+    {
+      std::string name(parts[i]);
+      unsigned int weight = 1;
+      std::string::size_type colon = name.find(':');
+      if (colon != std::string::npos)
+	{
+	  weight = parse_number("--mix", name.c_str() + colon + 1);
+	  name.erase(colon);
+	}
+      const Reloc_kind* k;
+      for (k = target.kinds; k->name != NULL; ++k)
+	if (name == k->name)
+	  break;
+      if (k->name == NULL)
+	return false;
+      for (unsigned int j = 0; j < weight; ++j)
+	pattern->push_back(k);
+    }
+  return !pattern->empty();
+}
+
+// Name of a symbol defined by object OBJ.
+
+std::string
+function_name(unsigned int obj, unsigned int i)
+{
+  char buf[50];
+  snprintf(buf, sizeof buf, "f%u_%u", obj, i);
+  return buf;
+}
+
+std::string
+data_name(unsigned int obj)
+{
+  char buf[50];
+  snprintf(buf, sizeof buf, "d%u", obj);
+  return buf;
+}
+
+// Build up a string table.
+
+class Strtab
+{
+ public:
+  Strtab()
+    : data_(1, '\0')
+  { }
+
+  unsigned int
+  add(const std::string& s)
+  {
+    unsigned int ret = this->data_.size();
+    this->data_.append(s);
+    this->data_.push_back('\0');
+    return ret;
+  }
+
+  const std::string&
+  data() const
+  { return this->data_; }
+
+ private:
+  std::string data_;
+};
+
+// Write object OBJ of OBJECTS for TARGET to FILENAME, with RELOCS
+// relocations following PATTERN.  If WITH_RELOCS is false, leave out
+// the relocation section.  Return false on error.
+
+template<int size>
+bool
+write_object(const Target_desc& target,
+	     const std::vector<const Reloc_kind*>& pattern,
+	     unsigned int obj, unsigned int objects, unsigned int relocs,
+	     bool with_relocs, const std::string& filename)
+{
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+  const int ehdr_size = elfcpp::Elf_sizes<size>::ehdr_size;
+  const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+  const int reloc_size = (target.is_rela
+			  ? elfcpp::Elf_sizes<size>::rela_size
+			  : elfcpp::Elf_sizes<size>::rel_size);
+
+  // Lay out the .text contents, one field per relocation.
+  std::vector<unsigned char> text;
+  std::vector<Address> offsets(relocs);
+  for (unsigned int i = 0; i < relocs; ++i)
+    {
+      const Reloc_kind* k = pattern[i % pattern.size()];
+      while (text.size() % k->size != 0)
+	text.push_back(0);
+      offsets[i] = text.size();
+      text.insert(text.end(), k->contents, k->contents + k->size);
+    }
+  while (text.size() < function_count * 16)
+    text.push_back(0);
+
+  // The symbols: the null symbol, the .text and .data section
+  // symbols, the functions and data defined here, _start in the first
+  // object, and the symbols defined by the next object.
+  const unsigned int text_shndx = 1;
+  const unsigned int data_shndx = 2;
+  const unsigned int data_section_sym = 2;
+  const unsigned int first_global = 3;
+  unsigned int other = (obj + 1) % objects;
+  bool have_start = obj == 0;
+  unsigned int undef_base = (first_global + function_count + 1
+			     + (have_start ? 1 : 0));
+  if (other == obj)
+    undef_base = first_global;
+
+  Strtab strtab;
+  std::vector<unsigned char> symtab;
+  std::vector<unsigned char> sym(sym_size);
+  unsigned int symcount = 0;
+
+  // Add a symbol to SYMTAB.
+#define ADD_SYM(name_off, value, sz, bind, type, shndx)			\
+  do									\
+    {									\
+      elfcpp::Sym_write<size, false> osym(&sym[0]);			\
+      osym.put_st_name(name_off);					\
+      osym.put_st_value(value);						\
+      osym.put_st_size(sz);						\
+      osym.put_st_info(bind, type);					\
+      osym.put_st_other(elfcpp::STV_DEFAULT, 0);			\
+      osym.put_st_shndx(shndx);						\
+      symtab.insert(symtab.end(), sym.begin(), sym.end());		\
+      ++symcount;							\
+    }									\
+  while (0)
+
+  ADD_SYM(0, 0, 0, elfcpp::STB_LOCAL, elfcpp::STT_NOTYPE, 0);
+  ADD_SYM(0, 0, 0, elfcpp::STB_LOCAL, elfcpp::STT_SECTION, text_shndx);
+  ADD_SYM(0, 0, 0, elfcpp::STB_LOCAL, elfcpp::STT_SECTION, data_shndx);
+  for (unsigned int i = 0; i < function_count; ++i)
+    ADD_SYM(strtab.add(function_name(obj, i)), i * 16, 4,
+	    elfcpp::STB_GLOBAL, elfcpp::STT_FUNC, text_shndx);
+  ADD_SYM(strtab.add(data_name(obj)), 0, data_size,
+	  elfcpp::STB_GLOBAL, elfcpp::STT_OBJECT, data_shndx);
+  if (have_start)
+    ADD_SYM(strtab.add("_start"), 0, 0, elfcpp::STB_GLOBAL,
+	    elfcpp::STT_FUNC, text_shndx);
+  if (other != obj)
+    {
+      for (unsigned int i = 0; i < function_count; ++i)
+	ADD_SYM(strtab.add(function_name(other, i)), 0, 0,
+		elfcpp::STB_GLOBAL, elfcpp::STT_FUNC, elfcpp::SHN_UNDEF);
+      ADD_SYM(strtab.add(data_name(other)), 0, 0,
+	      elfcpp::STB_GLOBAL, elfcpp::STT_OBJECT, elfcpp::SHN_UNDEF);
+    }
+
+#undef ADD_SYM
+
+  // The relocations.
+  std::vector<unsigned char> rel;
+  if (with_relocs)
+    {
+      rel.resize(relocs * reloc_size);
+      for (unsigned int i = 0; i < relocs; ++i)
+	{
+	  const Reloc_kind* k = pattern[i % pattern.size()];
+	  unsigned int r_sym;
+	  int64_t addend = 0;
+	  if (k->target == TARGET_FUNCTION)
+	    r_sym = undef_base + i % function_count;
+	  else if (k->target == TARGET_DATA && (i & 1) != 0)
+	    {
+	      r_sym = data_section_sym;
+	      addend = (i % (data_size / 4)) * 4;
+	    }
+	  else
+	    r_sym = undef_base + function_count;
+	  unsigned char* p = &rel[i * reloc_size];
+	  if (target.is_rela)
+	    {
+	      elfcpp::Rela_write<size, false> orel(p);
+	      orel.put_r_offset(offsets[i]);
+	      orel.put_r_info(elfcpp::elf_r_info<size>(r_sym, k->r_type));
+	      orel.put_r_addend(addend);
+	    }
+	  else
+	    {
+	      elfcpp::Rel_write<size, false> orel(p);
+	      orel.put_r_offset(offsets[i]);
+	      orel.put_r_info(elfcpp::elf_r_info<size>(r_sym, k->r_type));
+	    }
+	}
+    }
+
+  // The section names.
+  Strtab shstrtab;
+  unsigned int text_name = shstrtab.add(".text");
+  unsigned int data_name_off = shstrtab.add(".data");
+  unsigned int rel_name = shstrtab.add(target.is_rela
+				       ? ".rela.text"
+				       : ".rel.text");
+  unsigned int symtab_name = shstrtab.add(".symtab");
+  unsigned int strtab_name = shstrtab.add(".strtab");
+  unsigned int shstrtab_name = shstrtab.add(".shstrtab");
+
+  // Sections: null, .text, .data, .rel[a].text, .symtab, .strtab,
+  // .shstrtab.
+  const unsigned int shnum = 7;
+  const unsigned int rel_shndx = 3;
+  const unsigned int symtab_shndx = 4;
+  const unsigned int strtab_shndx = 5;
+  const unsigned int shstrtab_shndx = 6;
+
+  // Lay out the file.
+  off_t off = ehdr_size;
+  off_t text_off = off;
+  off += text.size();
+  off = (off + 7) & ~7;
+  off_t data_off = off;
+  off += data_size;
+  off_t rel_off = off;
+  off += rel.size();
+  off_t symtab_off = off;
+  off += symtab.size();
+  off_t strtab_off = off;
+  off += strtab.data().size();
+  off_t shstrtab_off = off;
+  off += shstrtab.data().size();
+  off = (off + 7) & ~7;
+  off_t shoff = off;
+  off += shnum * shdr_size;
+
+  std::vector<unsigned char> file(off);
+
+  elfcpp::Ehdr_write<size, false> oehdr(&file[0]);
+  unsigned char e_ident[elfcpp::EI_NIDENT];
+  memset(e_ident, 0, elfcpp::EI_NIDENT);
+  e_ident[elfcpp::EI_MAG0] = elfcpp::ELFMAG0;
+  e_ident[elfcpp::EI_MAG1] = elfcpp::ELFMAG1;
+  e_ident[elfcpp::EI_MAG2] = elfcpp::ELFMAG2;
+  e_ident[elfcpp::EI_MAG3] = elfcpp::ELFMAG3;
+  e_ident[elfcpp::EI_CLASS] = (size == 32
+			       ? elfcpp::ELFCLASS32
+			       : elfcpp::ELFCLASS64);
+  e_ident[elfcpp::EI_DATA] = elfcpp::ELFDATA2LSB;
+  e_ident[elfcpp::EI_VERSION] = elfcpp::EV_CURRENT;
+  oehdr.put_e_ident(e_ident);
+  oehdr.put_e_type(elfcpp::ET_REL);
+  oehdr.put_e_machine(target.machine);
+  oehdr.put_e_version(elfcpp::EV_CURRENT);
+  oehdr.put_e_entry(0);
+  oehdr.put_e_phoff(0);
+  oehdr.put_e_shoff(shoff);
+  oehdr.put_e_flags(target.flags);
+  oehdr.put_e_ehsize(ehdr_size);
+  oehdr.put_e_phentsize(0);
+  oehdr.put_e_phnum(0);
+  oehdr.put_e_shentsize(shdr_size);
+  oehdr.put_e_shnum(shnum);
+  oehdr.put_e_shstrndx(shstrtab_shndx);
+
+  if (!text.empty())
+    memcpy(&file[text_off], &text[0], text.size());
+  if (!rel.empty())
+    memcpy(&file[rel_off], &rel[0], rel.size());
+  memcpy(&file[symtab_off], &symtab[0], symtab.size());
+  memcpy(&file[strtab_off], strtab.data().data(), strtab.data().size());
+  memcpy(&file[shstrtab_off], shstrtab.data().data(),
+	 shstrtab.data().size());
+
+  struct
+  {
+    unsigned int name;
+    unsigned int type;
+    unsigned int flags;
+    off_t offset;
+    off_t length;
+    unsigned int link;
+    unsigned int info;
+    unsigned int addralign;
+    unsigned int entsize;
+  } shdrs[shnum] =
+  {
+    { 0, elfcpp::SHT_NULL, 0, 0, 0, 0, 0, 0, 0 },
+    { text_name, elfcpp::SHT_PROGBITS,
+      elfcpp::SHF_ALLOC | elfcpp::SHF_EXECINSTR,
+      text_off, static_cast<off_t>(text.size()), 0, 0, 16, 0 },
+    { data_name_off, elfcpp::SHT_PROGBITS,
+      elfcpp::SHF_ALLOC | elfcpp::SHF_WRITE,
+      data_off, data_size, 0, 0, 8, 0 },
+    { rel_name, target.is_rela ? elfcpp::SHT_RELA : elfcpp::SHT_REL, 0,
+      rel_off, static_cast<off_t>(rel.size()), symtab_shndx, text_shndx,
+      size / 8, static_cast<unsigned int>(reloc_size) },
+    { symtab_name, elfcpp::SHT_SYMTAB, 0,
+      symtab_off, static_cast<off_t>(symtab.size()), strtab_shndx,
+      first_global, size / 8, static_cast<unsigned int>(sym_size) },
+    { strtab_name, elfcpp::SHT_STRTAB, 0,
+      strtab_off, static_cast<off_t>(strtab.data().size()), 0, 0, 1, 0 },
+    { shstrtab_name, elfcpp::SHT_STRTAB, 0,
+      shstrtab_off, static_cast<off_t>(shstrtab.data().size()), 0, 0, 1,
+      0 },
+  };
+
+  // Without relocations, turn the relocation section into an empty
+  // section which the linker will discard.
+  if (!with_relocs)
+    {
+      shdrs[rel_shndx].type = elfcpp::SHT_NULL;
+      shdrs[rel_shndx].link = 0;
+      shdrs[rel_shndx].info = 0;
+      shdrs[rel_shndx].entsize = 0;
+    }
+
+  for (unsigned int i = 0; i < shnum; ++i)
+    {
+      elfcpp::Shdr_write<size, false> oshdr(&file[shoff + i * shdr_size]);
+      oshdr.put_sh_name(shdrs[i].name);
+      oshdr.put_sh_type(shdrs[i].type);
+      oshdr.put_sh_flags(shdrs[i].flags);
+      oshdr.put_sh_addr(0);
+      oshdr.put_sh_offset(shdrs[i].offset);
+      oshdr.put_sh_size(shdrs[i].length);
+      oshdr.put_sh_link(shdrs[i].link);
+      oshdr.put_sh_info(shdrs[i].info);
+      oshdr.put_sh_addralign(shdrs[i].addralign);
+      oshdr.put_sh_entsize(shdrs[i].entsize);
+    }
+
+  FILE* f = fopen(filename.c_str(), "wb");
+  if (f == NULL)
+    {
+      fprintf(stderr, "reloc_bench: %s: %s\n", filename.c_str(),
+	      strerror(errno));
+      return false;
+    }
+  bool ok = fwrite(&file[0], 1, file.size(), f) == file.size();
+  if (fclose(f) != 0)
+    ok = false;
+  if (!ok)
+    fprintf(stderr, "reloc_bench: %s: write failed\n", filename.c_str());
+  return ok;
+}
+
+// Return the current time in seconds.
+
+double
+now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Run COMMAND REPEAT times and return the fastest time, or a negative
+// number if it failed.
+
+double
+time_command(const std::string& command, unsigned int repeat)
+{
+  double best = -1;
+  for (unsigned int i = 0; i < repeat; ++i)
+    {
+      double start = now();
+      int status = system(command.c_str());
+      double elapsed = now() - start;
+      if (status != 0)
+	return -1;
+      if (best < 0 || elapsed < best)
+	best = elapsed;
+    }
+  return best;
+}
+
+// Run the benchmark for one target.  Return false if the target could
+// not be benchmarked.
+
+bool
+run_target(const Options& options, const Target_desc& target)
+{
+  std::vector<const Reloc_kind*> pattern;
+  std::string mix(options.mix.empty() ? target.default_mix : options.mix);
+  if (!parse_mix(target, mix, &pattern))
+    {
+      fprintf(stderr, "reloc_bench: bad --mix for %s: %s\n", target.name,
+	      mix.c_str());
+      return false;
+    }
+
+  // Write the objects, with and without relocations.
+  std::string rel_files;
+  std::string norel_files;
+  for (unsigned int obj = 0; obj < options.objects; ++obj)
+    {
+      unsigned int relocs = options.relocs / options.objects;
+      if (obj < options.relocs % options.objects)
+	++relocs;
+      for (int with_relocs = 0; with_relocs < 2; ++with_relocs)
+	{
+	  char buf[100];
+	  snprintf(buf, sizeof buf, "/%s_%s%u.o", target.name,
+		   with_relocs ? "r" : "n", obj);
+	  std::string filename(options.dir + buf);
+	  bool ok;
+	  if (target.size == 32)
+	    ok = write_object<32>(target, pattern, obj, options.objects,
+				  relocs, with_relocs, filename);
+	  else
+	    ok = write_object<64>(target, pattern, obj, options.objects,
+				  relocs, with_relocs, filename);
+	  if (!ok)
+	    return false;
+	  (with_relocs ? rel_files : norel_files) += " " + filename;
+	}
+    }
+
+  std::string output(options.dir + "/" + target.name + ".out");
+  std::string errors(options.dir + "/" + target.name + ".err");
+  for (size_t i = 0; i < options.threads.size(); ++i)
+    {
+      unsigned int threads = options.threads[i];
+      std::string command(options.linker);
+      if (threads > 1)
+	{
+	  char buf[50];
+	  snprintf(buf, sizeof buf, " --threads --thread-count %u", threads);
+	  command += buf;
+	}
+      command += " -o " + output;
+
+      double norel_time = time_command(command + norel_files
+				       + " 2>" + errors,
+				       options.repeat);
+      double rel_time = (norel_time < 0
+			 ? -1
+			 : time_command(command + rel_files + " 2>" + errors,
+					options.repeat));
+      if (rel_time < 0)
+	{
+	  printf("%-8s %-40s %7u  link failed; see %s\n", target.name,
+		 mix.c_str(), threads, errors.c_str());
+	  if (i == 0)
+	    return false;
+	  continue;
+	}
+
+      double reloc_time = rel_time - norel_time;
+      if (reloc_time > 0)
+	printf("%-8s %-40s %7u %10u %10.3f %14.0f\n", target.name,
+	       mix.c_str(), threads, options.relocs, reloc_time,
+	       options.relocs / reloc_time);
+      else
+	printf("%-8s %-40s %7u %10u %10.3f %14s\n", target.name,
+	       mix.c_str(), threads, options.relocs, reloc_time, "-");
+      fflush(stdout);
+    }
+  return true;
+}
+
+} // End anonymous namespace.
+
+int
+main(int argc, char** argv)
+{
+  Options options;
+  std::string threads("1,2,4");
+  for (int i = 1; i < argc; ++i)
+    {
+      const char* arg = argv[i];
+      const char* eq = strchr(arg, '=');
+      std::string opt(arg, eq == NULL ? strlen(arg) : eq - arg);
+      const char* val = eq == NULL ? NULL : eq + 1;
+      if (opt == "--help")
+	{
+	  usage(stdout);
+	  return EXIT_SUCCESS;
+	}
+      else if (val == NULL)
+	{
+	  usage(stderr);
+	  return EXIT_FAILURE;
+	}
+      else if (opt == "--linker")
+	options.linker = val;
+      else if (opt == "--target")
+	options.target = val;
+      else if (opt == "--relocs")
+	options.relocs = parse_number("--relocs", val);
+      else if (opt == "--objects")
+	options.objects = parse_number("--objects", val);
+      else if (opt == "--threads")
+	threads = val;
+      else if (opt == "--mix")
+	options.mix = val;
+      else if (opt == "--repeat")
+	options.repeat = parse_number("--repeat", val);
+      else if (opt == "--dir")
+	options.dir = val;
+      else
+	{
+	  usage(stderr);
+	  return EXIT_FAILURE;
+	}
+    }
+
+  std::vector<std::string> thread_list(split(threads));
+  for (size_t i = 0; i < thread_list.size(); ++i)
+    options.threads.push_back(parse_number("--threads",
+					   thread_list[i].c_str()));
+
+  if (mkdir(options.dir.c_str(), 0777) != 0 && errno != EEXIST)
+    {
+      fprintf(stderr, "reloc_bench: %s: %s\n", options.dir.c_str(),
+	      strerror(errno));
+      return EXIT_FAILURE;
+    }
+
+  printf("%-8s %-40s %7s %10s %10s %14s\n", "target", "mix", "threads",
+	 "relocs", "seconds", "relocs/second");
+
+  int ret = EXIT_SUCCESS;
+  bool found = false;
+  for (unsigned int i = 0; i < target_count; ++i)
+    {
+      if (options.target != "all" && options.target != targets[i].name)
+	continue;
+      found = true;
+      if (!run_target(options, targets[i]) && options.target != "all")
+	ret = EXIT_FAILURE;
+    }
+  if (!found)
+    {
+      fprintf(stderr, "reloc_bench: unknown target: %s\n",
+	      options.target.c_str());
+      return EXIT_FAILURE;
+    }
+  return ret;
+}
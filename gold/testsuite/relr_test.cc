@@ -0,0 +1,639 @@
+// relr_test.cc -- test -z pack-relative-relocs.
+
+// Copyright 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This program stands in for the dynamic linker, so that the test
+// does not depend on the system's dynamic linker supporting DT_RELR.
+// It loads a shared library built from relr_test_1.cc at an
+// arbitrary base address, applies the packed relative relocs and the
+// ordinary relative relocs, and checks the pointer tables in the
+// library.  It takes two libraries: the first linked with
+// -z pack-relative-relocs, and the second linked without it.  Both
+// must relocate the same words, relative to their sections, to the
+// same targets.
+
+#include "config.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "elfcpp.h"
+#include "arm.h"
+#include "i386.h"
+#include "x86_64.h"
+
+namespace
+{
+
+// What we found when loading a library.
+
+struct Load_result
+{
+  Load_result()
+    : packed_count(0), packed_entries(0), relative_count(0),
+      supported(false), errors(0), words()
+  { }
+
+  // The number of words relocated by DT_RELR.
+  size_t packed_count;
+  // The number of entries in DT_RELR.
+  size_t packed_entries;
+  // The number of words relocated by ordinary relative relocs.
+  size_t relative_count;
+  // Whether gold packs relative relocs for this target.
+  bool supported;
+  // The number of errors.
+  int errors;
+  // Each relocated word, as "SECTION+OFFSET -> SECTION+OFFSET", sorted.
+  std::vector<std::string> words;
+};
+
+// Read the file NAME into CONTENTS.
+
+bool
+read_file(const char* name, std::vector<unsigned char>* contents)
+{
+  FILE* f = fopen(name, "rb");
+  if (f == NULL)
+    {
+      fprintf(stderr, "relr_test: cannot open %s\n", name);
+      return false;
+    }
+  unsigned char buf[8192];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof buf, f)) > 0)
+    contents->insert(contents->end(), buf, buf + len);
+  fclose(f);
+  return true;
+}
+
+// The reloc classes for SHT_REL and SHT_RELA.
+
+template<int sh_type, int size, bool big_endian>
+struct Reloc_types;
+
+template<int size, bool big_endian>
+struct Reloc_types<elfcpp::SHT_REL, size, big_endian>
+{
+  typedef elfcpp::Rel<size, big_endian> Reloc;
+  static const int reloc_size = elfcpp::Elf_sizes<size>::rel_size;
+
+  static typename elfcpp::Elf_types<size>::Elf_Addr
+  get_addend(const Reloc&)
+  { return 0; }
+};
+
+template<int size, bool big_endian>
+struct Reloc_types<elfcpp::SHT_RELA, size, big_endian>
+{
+  typedef elfcpp::Rela<size, big_endian> Reloc;
+  static const int reloc_size = elfcpp::Elf_sizes<size>::rela_size;
+
+  static typename elfcpp::Elf_types<size>::Elf_Addr
+  get_addend(const Reloc& reloc)
+  { return reloc.get_r_addend(); }
+};
+
+// A loaded library.
+
+template<int size, bool big_endian>
+class Loader
+{
+ public:
+  typedef typename elfcpp::Elf_types<size>::Elf_Addr Address;
+
+  Loader(const char* name, const std::vector<unsigned char>& file)
+    : name_(name), file_(file), image_(), relocated_(), result_()
+  { }
+
+  // Load and check the library.
+  Load_result
+  run();
+
+ private:
+  static const int word_size = size / 8;
+  // The address at which we load the library.
+  static const Address base = 0x10000000;
+
+  // Report an error.
+  void
+  error(const char* msg, Address address)
+  {
+    fprintf(stderr, "relr_test: %s: %s at %#llx\n", this->name_, msg,
+	    static_cast<unsigned long long>(address));
+    ++this->result_.errors;
+  }
+
+  // Return a pointer to the word at ADDRESS in the image, or NULL.
+  unsigned char*
+  image_word(Address address)
+  {
+    if (address + word_size > this->image_.size())
+      return NULL;
+    return &this->image_[0] + address;
+  }
+
+  // Apply a relative reloc to the word at ADDRESS.  If HAVE_ADDEND is
+  // true, ADDEND is the addend, otherwise it is in the word.
+  void
+  relocate(Address address, bool have_addend, Address addend);
+
+  // Apply the relocs in the DT_RELR table at ADDRESS.
+  void
+  apply_relr(Address address, Address relr_size, Address relr_ent);
+
+  // Apply the relative relocs of type SH_TYPE at ADDRESS.
+  template<int sh_type>
+  void
+  apply_relocs(Address address, Address rel_size, unsigned int r_type);
+
+  // Return the value of the symbol NAME in the symbol table.
+  bool
+  symbol_value(const char* name, Address* value);
+
+  // Describe ADDRESS as the name of the allocated section holding it
+  // and the offset within that section.
+  std::string
+  describe(Address address);
+
+  // Record each relocated word in the result.
+  void
+  record_words();
+
+  // Check the pointer table at TABLE against the index table at
+  // INDEX, which have COUNT entries.  STRIDE is the distance between
+  // pointers.
+  void
+  check_table(Address table, Address index, Address targets, int count,
+	      unsigned int stride);
+
+  // The name of the library.
+  const char* name_;
+  // The contents of the file.
+  const std::vector<unsigned char>& file_;
+  // The loaded image, indexed by link-time address.
+  std::vector<unsigned char> image_;
+  // The words which have been relocated.
+  std::set<Address> relocated_;
+  // What we found.
+  Load_result result_;
+};
+
+template<int size, bool big_endian>
+void
+Loader<size, big_endian>::relocate(Address address, bool have_addend,
+				   Address addend)
+{
+  unsigned char* p = this->image_word(address);
+  if (p == NULL)
+    {
+      this->error("reloc outside image", address);
+      return;
+    }
+  if (!this->relocated_.insert(address).second)
+    {
+      this->error("word relocated twice", address);
+      return;
+    }
+  if (!have_addend)
+    addend = elfcpp::Swap_unaligned<size, big_endian>::readval(p);
+  elfcpp::Swap_unaligned<size, big_endian>::writeval(p, base + addend);
+}
+
+// Decode DT_RELR.  An even entry is the address of a word to
+// relocate.  An odd entry is a bitmap of the words to relocate among
+// the next SIZE - 1 words.
+
+template<int size, bool big_endian>
+void
+Loader<size, big_endian>::apply_relr(Address address, Address relr_size,
+				     Address relr_ent)
+{
+  if (relr_ent != word_size)
+    {
+      this->error("bad DT_RELRENT", relr_ent);
+      return;
+    }
+
+  Address where = 0;
+  bool have_where = false;
+  for (Address i = 0; i < relr_size; i += word_size)
+    {
+      const unsigned char* p = this->image_word(address + i);
+      if (p == NULL)
+	{
+	  this->error("DT_RELR outside image", address + i);
+	  return;
+	}
+      Address entry = elfcpp::Swap<size, big_endian>::readval(p);
+      ++this->result_.packed_entries;
+      if ((entry & 1) == 0)
+	{
+	  this->relocate(entry, false, 0);
+	  ++this->result_.packed_count;
+	  where = entry + word_size;
+	  have_where = true;
+	}
+      else
+	{
+	  if (!have_where)
+	    {
+	      this->error("DT_RELR starts with a bitmap", address + i);
+	      return;
+	    }
+	  for (int bit = 0; bit < size - 1; ++bit)
+	    {
+	      if ((entry >> (bit + 1)) & 1)
+		{
+		  this->relocate(where + bit * word_size, false, 0);
+		  ++this->result_.packed_count;
+		}
+	    }
+	  where += (size - 1) * word_size;
+	}
+    }
+}
+
+template<int size, bool big_endian>
+template<int sh_type>
+void
+Loader<size, big_endian>::apply_relocs(Address address, Address rel_size,
+				       unsigned int r_type)
+{
+  typedef Reloc_types<sh_type, size, big_endian> Types;
+  const int reloc_size = Types::reloc_size;
+  for (Address i = 0; i + reloc_size <= rel_size; i += reloc_size)
+    {
+      const unsigned char* p = this->image_word(address + i);
+      if (p == NULL)
+	{
+	  this->error("relocs outside image", address + i);
+	  return;
+	}
+      typename Types::Reloc reloc(p);
+      if (elfcpp::elf_r_type<size>(reloc.get_r_info()) != r_type)
+	continue;
+      this->relocate(reloc.get_r_offset(), sh_type == elfcpp::SHT_RELA,
+		     Types::get_addend(reloc));
+      ++this->result_.relative_count;
+    }
+}
+
+template<int size, bool big_endian>
+bool
+Loader<size, big_endian>::symbol_value(const char* name, Address* value)
+{
+  const unsigned char* pfile = &this->file_[0];
+  elfcpp::Ehdr<size, big_endian> ehdr(pfile);
+  const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+  const int sym_size = elfcpp::Elf_sizes<size>::sym_size;
+  for (unsigned int i = 0; i < ehdr.get_e_shnum(); ++i)
+    {
+      elfcpp::Shdr<size, big_endian> shdr(pfile + ehdr.get_e_shoff()
+					  + i * shdr_size);
+      if (shdr.get_sh_type() != elfcpp::SHT_SYMTAB)
+	continue;
+      elfcpp::Shdr<size, big_endian> strtab(pfile + ehdr.get_e_shoff()
+					    + shdr.get_sh_link() * shdr_size);
+      const char* names = reinterpret_cast<const char*>(pfile
+							+ strtab.get_sh_offset());
+      for (Address off = 0; off < shdr.get_sh_size(); off += sym_size)
+	{
+	  elfcpp::Sym<size, big_endian> sym(pfile + shdr.get_sh_offset() + off);
+	  if (strcmp(names + sym.get_st_name(), name) == 0)
+	    {
+	      *value = sym.get_st_value();
+	      return true;
+	    }
+	}
+    }
+  fprintf(stderr, "relr_test: %s: no symbol %s\n", this->name_, name);
+  ++this->result_.errors;
+  return false;
+}
+
+template<int size, bool big_endian>
+std::string
+Loader<size, big_endian>::describe(Address address)
+{
+  const unsigned char* pfile = &this->file_[0];
+  elfcpp::Ehdr<size, big_endian> ehdr(pfile);
+  const int shdr_size = elfcpp::Elf_sizes<size>::shdr_size;
+  elfcpp::Shdr<size, big_endian> shstrtab(pfile + ehdr.get_e_shoff()
+					  + ehdr.get_e_shstrndx() * shdr_size);
+  const char* names = reinterpret_cast<const char*>(pfile
+						    + shstrtab.get_sh_offset());
+  char buf[32];
+  // Look for a section holding ADDRESS, and then for a section ending
+  // at ADDRESS, which a pointer may point just past.
+  for (int at_end = 0; at_end < 2; ++at_end)
+    {
+      for (unsigned int i = 0; i < ehdr.get_e_shnum(); ++i)
+	{
+	  elfcpp::Shdr<size, big_endian> shdr(pfile + ehdr.get_e_shoff()
+					      + i * shdr_size);
+	  Address start = shdr.get_sh_addr();
+	  Address end = start + shdr.get_sh_size();
+	  if ((shdr.get_sh_flags() & elfcpp::SHF_ALLOC) == 0
+	      || address < start
+	      || (at_end ? address != end : address >= end))
+	    continue;
+	  snprintf(buf, sizeof buf, "+%#llx",
+		   static_cast<unsigned long long>(address - start));
+	  return std::string(names + shdr.get_sh_name()) + buf;
+	}
+    }
+  snprintf(buf, sizeof buf, "%#llx", static_cast<unsigned long long>(address));
+  return buf;
+}
+
+template<int size, bool big_endian>
+void
+Loader<size, big_endian>::record_words()
+{
+  for (typename std::set<Address>::const_iterator p = this->relocated_.begin();
+       p != this->relocated_.end();
+       ++p)
+    {
+      const unsigned char* pword = this->image_word(*p);
+      Address target = (elfcpp::Swap_unaligned<size, big_endian>::readval(pword)
+			- base);
+      this->result_.words.push_back(this->describe(*p) + " -> "
+				    + this->describe(target));
+    }
+  std::sort(this->result_.words.begin(), this->result_.words.end());
+}
+
+template<int size, bool big_endian>
+void
+Loader<size, big_endian>::check_table(Address table, Address index,
+				      Address targets, int count,
+				      unsigned int stride)
+{
+  for (int i = 0; i < count; ++i)
+    {
+      Address address = table + i * stride;
+      const unsigned char* p = this->image_word(address);
+      const unsigned char* pindex = this->image_word(index + i * 4);
+      if (p == NULL || pindex == NULL)
+	{
+	  this->error("table outside image", address);
+	  return;
+	}
+      int32_t target = elfcpp::Swap<32, big_endian>::readval(pindex);
+      Address want = target < 0 ? 0 : base + targets + target * 4;
+      Address got = elfcpp::Swap_unaligned<size, big_endian>::readval(p);
+      if (got != want)
+	this->error("wrong pointer", address);
+      if (target >= 0 && this->relocated_.find(address) == this->relocated_.end())
+	this->error("pointer not relocated", address);
+    }
+}
+
+template<int size, bool big_endian>
+Load_result
+Loader<size, big_endian>::run()
+{
+  this->result_ = Load_result();
+
+  const unsigned char* pfile = &this->file_[0];
+  elfcpp::Ehdr<size, big_endian> ehdr(pfile);
+
+  unsigned int r_type;
+  switch (ehdr.get_e_machine())
+    {
+    case elfcpp::EM_X86_64:
+      r_type = elfcpp::R_X86_64_RELATIVE;
+      this->result_.supported = true;
+      break;
+    case elfcpp::EM_386:
+      r_type = elfcpp::R_386_RELATIVE;
+      break;
+    case elfcpp::EM_ARM:
+      r_type = elfcpp::R_ARM_RELATIVE;
+      this->result_.supported = true;
+      break;
+    default:
+      this->error("unsupported machine", ehdr.get_e_machine());
+      return this->result_;
+    }
+
+  // Load the segments, and find the dynamic section.
+  const int phdr_size = elfcpp::Elf_sizes<size>::phdr_size;
+  Address dynamic = 0;
+  Address dynamic_size = 0;
+  for (unsigned int i = 0; i < ehdr.get_e_phnum(); ++i)
+    {
+      elfcpp::Phdr<size, big_endian> phdr(pfile + ehdr.get_e_phoff()
+					  + i * phdr_size);
+      if (phdr.get_p_type() == elfcpp::PT_DYNAMIC)
+	{
+	  dynamic = phdr.get_p_vaddr();
+	  dynamic_size = phdr.get_p_memsz();
+	}
+      if (phdr.get_p_type() != elfcpp::PT_LOAD)
+	continue;
+      Address end = phdr.get_p_vaddr() + phdr.get_p_memsz();
+      if (end > this->image_.size())
+	this->image_.resize(end);
+      memcpy(&this->image_[0] + phdr.get_p_vaddr(),
+	     pfile + phdr.get_p_offset(), phdr.get_p_filesz());
+    }
+  if (dynamic_size == 0)
+    {
+      this->error("no PT_DYNAMIC", 0);
+      return this->result_;
+    }
+
+  Address rel = 0, rel_size = 0, rela = 0, rela_size = 0;
+  Address relr = 0, relr_size = 0, relr_ent = 0;
+  const int dyn_size = elfcpp::Elf_sizes<size>::dyn_size;
+  for (Address off = 0; off + dyn_size <= dynamic_size; off += dyn_size)
+    {
+      elfcpp::Dyn<size, big_endian> dyn(&this->image_[0] + dynamic + off);
+      switch (dyn.get_d_tag())
+	{
+	case elfcpp::DT_REL:
+	  rel = dyn.get_d_ptr();
+	  break;
+	case elfcpp::DT_RELSZ:
+	  rel_size = dyn.get_d_val();
+	  break;
+	case elfcpp::DT_RELA:
+	  rela = dyn.get_d_ptr();
+	  break;
+	case elfcpp::DT_RELASZ:
+	  rela_size = dyn.get_d_val();
+	  break;
+	case elfcpp::DT_RELR:
+	  relr = dyn.get_d_ptr();
+	  break;
+	case elfcpp::DT_RELRSZ:
+	  relr_size = dyn.get_d_val();
+	  break;
+	case elfcpp::DT_RELRENT:
+	  relr_ent = dyn.get_d_val();
+	  break;
+	default:
+	  break;
+	}
+    }
+
+  if (relr_size > 0)
+    this->apply_relr(relr, relr_size, relr_ent);
+  if (rel_size > 0)
+    this->apply_relocs<elfcpp::SHT_REL>(rel, rel_size, r_type);
+  if (rela_size > 0)
+    this->apply_relocs<elfcpp::SHT_RELA>(rela, rela_size, r_type);
+  this->record_words();
+
+  Address targets, table, index, count, misaligned, misaligned_index;
+  Address misaligned_count;
+  if (!this->symbol_value("relr_test_targets", &targets)
+      || !this->symbol_value("relr_test_table", &table)
+      || !this->symbol_value("relr_test_index", &index)
+      || !this->symbol_value("relr_test_count", &count)
+      || !this->symbol_value("relr_test_misaligned", &misaligned)
+      || !this->symbol_value("relr_test_misaligned_index", &misaligned_index)
+      || !this->symbol_value("relr_test_misaligned_count", &misaligned_count))
+    return this->result_;
+
+  const unsigned char* pcount = this->image_word(count);
+  const unsigned char* pmisaligned_count = this->image_word(misaligned_count);
+  if (pcount == NULL || pmisaligned_count == NULL)
+    {
+      this->error("count outside image", count);
+      return this->result_;
+    }
+  this->check_table(table, index, targets,
+		    elfcpp::Swap<32, big_endian>::readval(pcount),
+		    word_size);
+  // Each entry of relr_test_misaligned is a char followed by a
+  // pointer.
+  this->check_table(misaligned + 1, misaligned_index, targets,
+		    elfcpp::Swap<32, big_endian>::readval(pmisaligned_count),
+		    word_size + 1);
+
+  return this->result_;
+}
+
+// Load the library NAME.
+
+Load_result
+load(const char* name)
+{
+  std::vector<unsigned char> file;
+  Load_result failed;
+  failed.errors = 1;
+  if (!read_file(name, &file))
+    return failed;
+  if (file.size() < elfcpp::EI_NIDENT
+      || file[elfcpp::EI_MAG0] != elfcpp::ELFMAG0
+      || file[elfcpp::EI_MAG1] != elfcpp::ELFMAG1
+      || file[elfcpp::EI_MAG2] != elfcpp::ELFMAG2
+      || file[elfcpp::EI_MAG3] != elfcpp::ELFMAG3)
+    {
+      fprintf(stderr, "relr_test: %s: not an ELF file\n", name);
+      return failed;
+    }
+
+  bool big_endian = file[elfcpp::EI_DATA] == elfcpp::ELFDATA2MSB;
+  if (file[elfcpp::EI_CLASS] == elfcpp::ELFCLASS32)
+    {
+      if (big_endian)
+	return Loader<32, true>(name, file).run();
+      return Loader<32, false>(name, file).run();
+    }
+  else
+    {
+      if (big_endian)
+	return Loader<64, true>(name, file).run();
+      return Loader<64, false>(name, file).run();
+    }
+}
+
+} // End anonymous namespace.
+
+int
+main(int argc, char** argv)
+{
+  if (argc != 3)
+    {
+      fprintf(stderr, "usage: relr_test PACKED UNPACKED\n");
+      return EXIT_FAILURE;
+    }
+
+  Load_result packed = load(argv[1]);
+  Load_result unpacked = load(argv[2]);
+  int errors = packed.errors + unpacked.errors;
+
+  printf("%s: %lu packed relocs in %lu entries, %lu relative relocs\n",
+	 argv[1], static_cast<unsigned long>(packed.packed_count),
+	 static_cast<unsigned long>(packed.packed_entries),
+	 static_cast<unsigned long>(packed.relative_count));
+  printf("%s: %lu packed relocs in %lu entries, %lu relative relocs\n",
+	 argv[2], static_cast<unsigned long>(unpacked.packed_count),
+	 static_cast<unsigned long>(unpacked.packed_entries),
+	 static_cast<unsigned long>(unpacked.relative_count));
+
+  if (packed.errors == 0 && !packed.supported)
+    {
+      // -z pack-relative-relocs is ignored for this target, so we
+      // can only check that the relocs are the same.
+      printf("relative relocs are not packed for this target\n");
+    }
+  else if (packed.packed_count == 0)
+    {
+      fprintf(stderr, "relr_test: %s: no packed relocs\n", argv[1]);
+      ++errors;
+    }
+  if (unpacked.packed_count != 0)
+    {
+      fprintf(stderr, "relr_test: %s: unexpected packed relocs\n", argv[2]);
+      ++errors;
+    }
+  if (packed.packed_count + packed.relative_count
+      != unpacked.packed_count + unpacked.relative_count)
+    {
+      fprintf(stderr, "relr_test: different numbers of relocated words\n");
+      ++errors;
+    }
+  else if (packed.words != unpacked.words)
+    {
+      for (size_t i = 0; i < packed.words.size(); ++i)
+	if (packed.words[i] != unpacked.words[i])
+	  {
+	    fprintf(stderr, "relr_test: relocated word %s differs from %s\n",
+		    packed.words[i].c_str(), unpacked.words[i].c_str());
+	    break;
+	  }
+      ++errors;
+    }
+
+  if (errors != 0)
+    return EXIT_FAILURE;
+  printf("PASS\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+#!/bin/sh
+
+# relr_test.sh -- test -z pack-relative-relocs.
+
+# Copyright 2026 Free Software Foundation, Inc.
+
+# This file is part of gold.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+# MA 02110-1301, USA.
+
+# relr_test.stdout is the output of relr_test, which applies the
+# relocs of relr_test_1.so, linked with -z pack-relative-relocs, and
+# relr_test_2.so, linked without it, and checks the results.
+
+check()
+{
+    file=$1
+    pattern=$2
+    found=`grep "$pattern" $file`
+    if test -z "$found"; then
+        echo "pattern \"$pattern\" not found in file $file."
+	echo $found
+        exit 1
+    fi
+}
+
+check relr_test.stdout "^relr_test_2.so: 0 packed relocs in 0 entries"
+check relr_test.stdout "^PASS$"
+
+exit 0
@@ -0,0 +1,87 @@
+// relr_test_1.cc -- a shared library for the -z pack-relative-relocs test.
+
+// Copyright 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// This library is not loaded by the dynamic linker.  relr_test reads
+// it, applies its relative relocs, and checks the pointer tables
+// against the index tables.  The targets are hidden, so that every
+// pointer gets a relative reloc.
+
+// The entries of relr_test_table.  X(I) is a pointer to
+// relr_test_targets[I], and N is a null pointer.  The gaps between
+// the pointers test the different ways of encoding them: runs which
+// fit in one bitmap, gaps which only just fit, and gaps which need a
+// new address entry.
+
+#define N8 N N N N N N N N
+#define N64 N8 N8 N8 N8 N8 N8 N8 N8
+
+#define RELR_TEST_ENTRIES \
+  X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) \
+  X(8) X(9) X(10) X(11) X(12) X(13) X(14) X(15) \
+  N64 N64 \
+  X(16) N X(17) N N X(18) N N N X(19) \
+  X(20) N8 N8 N8 N8 N8 N8 N8 N N N N N N X(21) \
+  X(22) N8 N8 N8 N8 N8 N8 N8 N N N N N N N X(23) \
+  X(24) N64 X(25) \
+  X(26) X(27) X(28) X(29) X(30) X(31) X(32) X(33) \
+  X(34) X(35) X(36) X(37) X(38) X(39) X(40) X(41) \
+  X(42) X(43) X(44) X(45) X(46) X(47) X(48) X(49) \
+  X(50) X(51) X(52) X(53) X(54) X(55) X(56) X(57) \
+  X(58) X(59) X(60) X(61) X(62) X(63) X(0) X(1) \
+  X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9)
+
+int relr_test_targets[64] __attribute__((visibility("hidden")));
+
+#define X(i) &relr_test_targets[i],
+#define N 0,
+int* relr_test_table[] = { RELR_TEST_ENTRIES };
+#undef X
+#undef N
+
+#define X(i) i,
+#define N -1,
+extern const int relr_test_index[] = { RELR_TEST_ENTRIES };
+#undef X
+#undef N
+
+extern const int relr_test_count =
+  sizeof relr_test_index / sizeof relr_test_index[0];
+
+// Pointers which are not aligned can not be packed, so they must
+// still get ordinary relocs.
+
+struct __attribute__((packed)) Relr_test_misaligned
+{
+  char c;
+  int* p;
+};
+
+Relr_test_misaligned relr_test_misaligned[] =
+{
+  { 'a', &relr_test_targets[1] },
+  { 'b', &relr_test_targets[2] },
+  { 'c', &relr_test_targets[3] },
+};
+
+extern const int relr_test_misaligned_index[] = { 1, 2, 3 };
+
+extern const int relr_test_misaligned_count =
+  sizeof relr_test_misaligned / sizeof relr_test_misaligned[0];
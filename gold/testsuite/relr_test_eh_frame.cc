@@ -0,0 +1,71 @@
+// relr_test_eh_frame.cc -- .eh_frame for the -z pack-relative-relocs test.
+
+// Copyright 2026 Free Software Foundation, Inc.
+
+// This file is part of gold.
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+// MA 02110-1301, USA.
+
+// The relr_test libraries are linked with two copies of this file.
+// Each has a CIE and an FDE written out by hand, with an absolute
+// pc_begin, so that the FDE needs a relative reloc in a shared
+// library.  The two CIEs are the same, so gold merges them, and the
+// FDE of the second copy moves within the output .eh_frame.  Those
+// relocs must not be packed.
+
+extern "C"
+{
+
+static void __attribute__((used))
+relr_test_eh_frame_function()
+{
+}
+
+}
+
+#if __SIZEOF_POINTER__ == 8
+#define RELR_TEST_WORD ".quad"
+#define RELR_TEST_ALIGN "3"
+#else
+#define RELR_TEST_WORD ".long"
+#define RELR_TEST_ALIGN "2"
+#endif
+
+__asm__(
+  "\t.pushsection .eh_frame,\"a\"\n"
+  "\t.p2align " RELR_TEST_ALIGN "\n"
+  ".Lrelr_test_cie:\n"
+  "\t.long .Lrelr_test_cie_end - .Lrelr_test_cie_start\n"
+  ".Lrelr_test_cie_start:\n"
+  "\t.long 0\n"			// CIE id.
+  "\t.byte 1\n"			// Version.
+  "\t.string \"zR\"\n"		// Augmentation.
+  "\t.uleb128 1\n"		// Code alignment factor.
+  "\t.sleb128 -4\n"		// Data alignment factor.
+  "\t.uleb128 0\n"		// Return address register.
+  "\t.uleb128 1\n"		// Augmentation data length.
+  "\t.byte 0\n"			// FDE encoding: DW_EH_PE_absptr.
+  "\t.p2align " RELR_TEST_ALIGN "\n"
+  ".Lrelr_test_cie_end:\n"
+  "\t.long .Lrelr_test_fde_end - .Lrelr_test_fde_start\n"
+  ".Lrelr_test_fde_start:\n"
+  "\t.long .Lrelr_test_fde_start - .Lrelr_test_cie\n"
+  "\t" RELR_TEST_WORD " relr_test_eh_frame_function\n"	// pc_begin.
+  "\t" RELR_TEST_WORD " 1\n"	// pc_range.
+  "\t.uleb128 0\n"		// Augmentation data length.
+  "\t.p2align " RELR_TEST_ALIGN "\n"
+  ".Lrelr_test_fde_end:\n"
+  "\t.popsection\n");
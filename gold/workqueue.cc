@@ -22,8 +22,12 @@
 
 #include "gold.h"
 
+#include <cstdio>
+#include <algorithm>
+
 #include "debug.h"
 #include "options.h"
+#include "parameters.h"
 #include "timer.h"
 #include "workqueue.h"
 #include "workqueue-internal.h"
@@ -114,14 +118,147 @@ class Workqueue_threader_single : public Workqueue_threader
   { return false; }
 };
 
+// Class Parallel_job.  This holds the state shared by the threads
+// running a Workqueue::run_in_parallel request.  Helper tasks may not
+// start until after all the parts are done, so this is reference
+// counted, and the last user deletes it.
+
+class Parallel_job
+{
+ public:
+  Parallel_job(Parallel_runner* runner, unsigned int count, int refs)
+    : lock_(), condvar_(this->lock_), runner_(runner), count_(count),
+      next_(0), done_(0), refs_(refs)
+  { }
+
+  // Claim parts which nobody has started, and run them.
+  void
+  run_parts();
+
+  // Wait until every part has been run.
+  void
+  wait();
+
+  // Drop a reference.  This may delete the job.
+  void
+  release();
+
+ private:
+  Parallel_job(const Parallel_job&);
+  Parallel_job& operator=(const Parallel_job&);
+
+  // Controls access to the remaining members.
+  Lock lock_;
+  // Signalled when the last part is done.
+  Condvar condvar_;
+  // The work to do.  This may not be used after all the parts are
+  // done, since the caller will then return.
+  Parallel_runner* runner_;
+  // The number of parts.
+  unsigned int count_;
+  // The next part to run.
+  unsigned int next_;
+  // The number of parts completed.
+  unsigned int done_;
+  // The number of references.
+  int refs_;
+};
+
+void
+Parallel_job::run_parts()
+{
+  while (true)
+    {
+      unsigned int part;
+      Parallel_runner* runner;
+      {
+	Hold_lock hl(this->lock_);
+	if (this->next_ >= this->count_)
+	  return;
+	part = this->next_;
+	++this->next_;
+	runner = this->runner_;
+      }
+
+      runner->run(part);
+
+      {
+	Hold_lock hl(this->lock_);
+	++this->done_;
+	if (this->done_ == this->count_)
+	  this->condvar_.broadcast();
+      }
+    }
+}
+
+void
+Parallel_job::wait()
+{
+  Hold_lock hl(this->lock_);
+  while (this->done_ < this->count_)
+    this->condvar_.wait();
+}
+
+void
+Parallel_job::release()
+{
+  bool last;
+  {
+    Hold_lock hl(this->lock_);
+    --this->refs_;
+    last = this->refs_ == 0;
+  }
+  if (last)
+    delete this;
+}
+
+// A task which helps run a Parallel_job.  It holds no locks and is
+// always runnable.
+
+class Parallel_job_task : public Task
+{
+ public:
+  Parallel_job_task(Parallel_job* job)
+    : job_(job)
+  { }
+
+  Task_token*
+  is_runnable()
+  { return NULL; }
+
+  void
+  locks(Task_locker*)
+  { }
+
+  void
+  run(Workqueue*)
+  {
+    this->job_->run_parts();
+    this->job_->release();
+  }
+
+  std::string
+  get_name() const
+  { return "Parallel_job_task"; }
+
+ private:
+  Parallel_job* job_;
+};
+
 // Workqueue methods.
 
+Workqueue* Workqueue::current;
+
 Workqueue::Workqueue(const General_options& options)
   : lock_(),
     first_tasks_(),
     tasks_(),
     running_(0),
     waiting_(0),
+    idle_(0),
+    tasks_run_(0),
+    idle_waits_(0),
+    thread_count_(1),
     condvar_(this->lock_),
     threader_(NULL)
 {
@@ -139,10 +276,13 @@ Workqueue::Workqueue(const General_options& options)
       gold_unreachable();
 #endif
     }
+  gold_assert(Workqueue::current == NULL);
+  Workqueue::current = this;
 }
 
 Workqueue::~Workqueue()
 {
+  Workqueue::current = NULL;
 }
 
 // Add a task to the end of a specific queue, or put it on the list
@@ -168,8 +308,11 @@ Workqueue::add_to_queue(Task_list* queue, Task* t, bool front)
 	queue->push_front(t);
       else
 	queue->push_back(t);
-      // Tell any waiting thread that there is work to do.
-      this->condvar_.signal();
+      // Tell any waiting thread that there is work to do.  If no
+      // thread is waiting, there is no point to signalling the
+      // condition variable; some running thread will find the task.
+      if (this->idle_ > 0)
+	this->condvar_.signal();
     }
 }
 
@@ -269,7 +412,10 @@ Workqueue::find_runnable_or_wait(int thread_number)
 
       gold_debug(DEBUG_TASK, "%3d sleeping", thread_number);
 
+      ++this->idle_waits_;
+      ++this->idle_;
       this->condvar_.wait();
+      --this->idle_;
 
       gold_debug(DEBUG_TASK, "%3d awake", thread_number);
 
@@ -305,6 +451,7 @@ Workqueue::find_and_run_task(int thread_number)
     t->locks(&tl);
 
     ++this->running_;
+    ++this->tasks_run_;
   }
 
   while (t != NULL)
@@ -352,6 +499,7 @@ Workqueue::find_and_run_task(int thread_number)
 	    next->locks(&tl);
 
 	    ++this->running_;
+	    ++this->tasks_run_;
 	  }
       }
 
@@ -431,7 +579,8 @@ Workqueue::return_or_queue(Task* t, bool is_blocker, Task** pret)
 	this->first_tasks_.push_back(t);
       else
 	this->tasks_.push_back(t);
-      this->condvar_.signal();
+      if (this->idle_ > 0)
+	this->condvar_.signal();
       return false;
     }
 
@@ -505,6 +654,7 @@ Workqueue::set_thread_count(int threads)
   Hold_lock hl(this->lock_);
 
   this->threader_->set_thread_count(threads);
+  this->thread_count_ = threads;
   // Wake up all the threads, since something has changed.
   this->condvar_.broadcast();
 }
@@ -518,4 +668,54 @@ Workqueue::add_blocker(Task_token* token)
   token->add_blocker();
 }
 
+// Return the number of threads which run_in_parallel may use.
+
+unsigned int
+Workqueue::parallel_thread_count()
+{
+  Workqueue* wq = Workqueue::current;
+  if (wq == NULL
+      || !parameters->options_valid()
+      || !parameters->options().threads())
+    return 1;
+  Hold_lock hl(wq->lock_);
+  return wq->thread_count_ > 1 ? wq->thread_count_ : 1;
+}
+
+// Run the parts of RUNNER, using idle threads to help.
+
+void
+Workqueue::run_in_parallel(Parallel_runner* runner, unsigned int count)
+{
+  unsigned int threads = Workqueue::parallel_thread_count();
+  if (count <= 1 || threads <= 1)
+    {
+      for (unsigned int i = 0; i < count; ++i)
+	runner->run(i);
+      return;
+    }
+
+  // Queue a helper task for each part beyond the one this thread
+  // will start on, up to the number of other threads.
+  unsigned int helpers = std::min(count, threads) - 1;
+  Parallel_job* job = new Parallel_job(runner, count, helpers + 1);
+  for (unsigned int i = 0; i < helpers; ++i)
+    Workqueue::current->queue_soon(new Parallel_job_task(job));
+
+  job->run_parts();
+  job->wait();
+  job->release();
+}
+
+// Print statistics about the work queue to stderr.
+
+void
+Workqueue::print_stats() const
+{
+  fprintf(stderr, _("%s: workqueue tasks run: %u\n"), program_name,
+	  this->tasks_run_);
+  fprintf(stderr, _("%s: workqueue idle waits: %u\n"), program_name,
+	  this->idle_waits_);
+}
+
 } // End namespace gold.
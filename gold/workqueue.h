@@ -27,7 +27,10 @@
 #ifndef GOLD_WORKQUEUE_H
 #define GOLD_WORKQUEUE_H
 
+#include <algorithm>
+#include <iterator>
 #include <string>
+#include <vector>
 
 #include "gold-threads.h"
 #include "token.h"
@@ -191,6 +194,21 @@ class Task_function : public Task
   const char* name_;
 };
 
+// An interface for work which can be split into independent parts
+// which may run at the same time.  See Workqueue::run_in_parallel.
+
+class Parallel_runner
+{
+ public:
+  virtual ~Parallel_runner()
+  { }
+
+  // Do part PART of the work.  This may be called on any thread,
+  // concurrently with other parts.
+  virtual void
+  run(unsigned int part) = 0;
+};
+
 // The workqueue itself.
 
 class Workqueue_threader;
@@ -233,6 +251,23 @@ class Workqueue
   void
   add_blocker(Task_token*);
 
+  // Print statistics about the work queue to stderr.  This is used
+  // for --stats.
+  void
+  print_stats() const;
+
+  // Run parts 0 to COUNT - 1 of RUNNER, and return when they are all
+  // done.  This may be called from a running Task.  The calling
+  // thread runs parts itself, and any idle workqueue threads help.
+  // When not using threads, the parts are simply run in order.
+  static void
+  run_in_parallel(Parallel_runner* runner, unsigned int count);
+
+  // Return the number of threads which run_in_parallel may use.  This
+  // is a reasonable number of parts to split work into.
+  static unsigned int
+  parallel_thread_count();
+
  private:
   // This class can not be copied.
   Workqueue(const Workqueue&);
@@ -270,6 +305,9 @@ class Workqueue
   bool
   should_cancel_thread(int thread_number);
 
+  // The Workqueue used by run_in_parallel.  There is only one.
+  static Workqueue* current;
+
   // Master Workqueue lock.  This controls access to the following
   // member variables.
   Lock lock_;
@@ -281,6 +319,16 @@ class Workqueue
   int running_;
   // Number of tasks waiting for a lock to release.
   int waiting_;
+  // Number of threads waiting on condvar_.
+  int idle_;
+  // Number of tasks run, for --stats.
+  unsigned int tasks_run_;
+  // Number of times a thread had nothing to do and went to sleep, for
+  // --stats.
+  unsigned int idle_waits_;
+  // The number of threads most recently requested by
+  // set_thread_count.
+  int thread_count_;
   // Condition variable associated with lock_.  This is signalled when
   // there may be a new Task to execute.
   Condvar condvar_;
@@ -290,6 +338,147 @@ class Workqueue
   Workqueue_threader* threader_;
 };
 
+// A Parallel_runner which sorts each of several pieces of a sequence.
+// This is used by parallel_sort.
+
+template<typename Iterator, typename Compare>
+class Parallel_sort_runner : public Parallel_runner
+{
+ public:
+  Parallel_sort_runner(Iterator first, const std::vector<size_t>& bounds,
+		       Compare comp, bool stable)
+    : first_(first), bounds_(bounds), comp_(comp), stable_(stable)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    Iterator b = this->first_ + this->bounds_[part];
+    Iterator e = this->first_ + this->bounds_[part + 1];
+    if (this->stable_)
+      std::stable_sort(b, e, this->comp_);
+    else
+      std::sort(b, e, this->comp_);
+  }
+
+ private:
+  Iterator first_;
+  const std::vector<size_t>& bounds_;
+  Compare comp_;
+  bool stable_;
+};
+
+// A Parallel_runner which merges adjacent pairs of sorted pieces from
+// one sequence into another.  Part I merges pieces 2*I and 2*I+1; if
+// there is no piece 2*I+1, piece 2*I is just copied.
+
+template<typename In, typename Out, typename Compare>
+class Parallel_merge_runner : public Parallel_runner
+{
+ public:
+  Parallel_merge_runner(In in, Out out, const std::vector<size_t>& bounds,
+			Compare comp)
+    : in_(in), out_(out), bounds_(bounds), comp_(comp)
+  { }
+
+  void
+  run(unsigned int part)
+  {
+    size_t pieces = this->bounds_.size() - 1;
+    size_t b = this->bounds_[2 * part];
+    size_t m = this->bounds_[std::min<size_t>(2 * part + 1, pieces)];
+    size_t e = this->bounds_[std::min<size_t>(2 * part + 2, pieces)];
+    // std::merge takes elements from the first range when they are
+    // equal, so merging preserves the order of equal elements.
+    std::merge(this->in_ + b, this->in_ + m, this->in_ + m, this->in_ + e,
+	       this->out_ + b, this->comp_);
+  }
+
+ private:
+  In in_;
+  Out out_;
+  const std::vector<size_t>& bounds_;
+  Compare comp_;
+};
+
+// Sort [FIRST, LAST) using COMP, using the workqueue threads for large
+// sequences.  Pieces are sorted in parallel and then merged in
+// parallel, pairwise.  If STABLE, the result is the same as
+// std::stable_sort; otherwise it is the same as std::sort provided
+// that no two elements compare equal.  Either way the result does not
+// depend on the number of threads.
+
+template<typename Iterator, typename Compare>
+void
+parallel_sort_1(Iterator first, Iterator last, Compare comp, bool stable)
+{
+  typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+  // Don't bother with pieces smaller than this.
+  const size_t min_piece = 8192;
+
+  size_t count = last - first;
+  size_t pieces = std::min<size_t>(Workqueue::parallel_thread_count(),
+				   count / min_piece);
+  if (pieces <= 1)
+    {
+      if (stable)
+	std::stable_sort(first, last, comp);
+      else
+	std::sort(first, last, comp);
+      return;
+    }
+
+  std::vector<size_t> bounds(pieces + 1);
+  for (size_t i = 0; i <= pieces; ++i)
+    bounds[i] = count / pieces * i + std::min(i, count % pieces);
+
+  Parallel_sort_runner<Iterator, Compare> sorter(first, bounds, comp, stable);
+  Workqueue::run_in_parallel(&sorter, pieces);
+
+  // Merge pairs of pieces back and forth between the sequence and a
+  // temporary buffer until there is only one piece.
+  std::vector<Value> tmp(count);
+  bool in_tmp = false;
+  while (bounds.size() > 2)
+    {
+      pieces = bounds.size() - 1;
+      unsigned int merges = (pieces + 1) / 2;
+      if (!in_tmp)
+	{
+	  Parallel_merge_runner<Iterator, typename std::vector<Value>::iterator,
+				Compare> merger(first, tmp.begin(), bounds, comp);
+	  Workqueue::run_in_parallel(&merger, merges);
+	}
+      else
+	{
+	  Parallel_merge_runner<typename std::vector<Value>::iterator, Iterator,
+				Compare> merger(tmp.begin(), first, bounds, comp);
+	  Workqueue::run_in_parallel(&merger, merges);
+	}
+      in_tmp = !in_tmp;
+
+      std::vector<size_t> new_bounds;
+      for (size_t i = 0; i < pieces; i += 2)
+	new_bounds.push_back(bounds[i]);
+      new_bounds.push_back(count);
+      bounds.swap(new_bounds);
+    }
+
+  if (in_tmp)
+    std::copy(tmp.begin(), tmp.end(), first);
+}
+
+template<typename Iterator, typename Compare>
+inline void
+parallel_sort(Iterator first, Iterator last, Compare comp)
+{ parallel_sort_1(first, last, comp, false); }
+
+template<typename Iterator, typename Compare>
+inline void
+parallel_stable_sort(Iterator first, Iterator last, Compare comp)
+{ parallel_sort_1(first, last, comp, true); }
+
 } // End namespace gold.
 
 #endif // !defined(GOLD_WORKQUEUE_H)
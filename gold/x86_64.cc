@@ -843,6 +843,12 @@ Target_x86_64::rela_dyn_section(Layout* layout)
       layout->add_output_section_data(".rela.dyn", elfcpp::SHT_RELA,
 				      elfcpp::SHF_ALLOC, this->rela_dyn_,
 				      ORDER_DYNAMIC_RELOCS, false);
+      if (parameters->options().pack_relative_relocs())
+	{
+	  Output_data_relr<64, false>* relr = new Output_data_relr<64, false>();
+	  layout->add_relr_dyn_section(relr);
+	  this->rela_dyn_->set_relr_section(relr, elfcpp::R_X86_64_RELATIVE);
+	}
     }
   return this->rela_dyn_;
 }